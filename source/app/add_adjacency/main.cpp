@@ -6,8 +6,10 @@
 ///
 import eagine.core;
 import eagine.shapes;
+import <filesystem>;
 import <iostream>;
 import <map>;
+import <memory>;
 
 namespace eagine {
 
@@ -20,8 +22,21 @@ static auto get_base_generator(main_ctx& ctx)
 auto main(main_ctx& ctx) -> int {
     using namespace eagine;
 
-    if(auto bgen{get_base_generator(ctx)}) {
-        if(auto gen{shapes::add_triangle_adjacency(std::move(bgen), ctx)}) {
+    std::shared_ptr<shapes::generator_instrumentation> instr;
+    if(ctx.args().find("--shape-instrument")) {
+        instr = std::make_shared<shapes::generator_instrumentation>();
+    }
+
+    if(auto bgen{shapes::instrument(get_base_generator(ctx), "input", instr)}) {
+        std::filesystem::path topology_dir;
+        if(const auto arg{ctx.args().find("--shape-topology-dir")}) {
+            topology_dir = to_string(arg.next().get());
+        }
+        if(auto gen{shapes::instrument(
+             shapes::add_triangle_adjacency(
+               std::move(bgen), 0, topology_dir, ctx),
+             "adjacency",
+             instr)}) {
             shapes::to_json_options opts;
             if(parse_from(ctx, *gen, opts)) {
                 shapes::to_json(std::cout, *gen, opts) << std::endl;
@@ -29,6 +44,9 @@ auto main(main_ctx& ctx) -> int {
         }
     }
 
+    if(instr) {
+        shapes::to_json(std::clog, *instr) << std::endl;
+    }
     return 0;
 }
 
@@ -6,8 +6,12 @@
 ///
 import eagine.core;
 import eagine.shapes;
+import <fstream>;
 import <iostream>;
 import <map>;
+import <memory>;
+import <string>;
+import <vector>;
 
 namespace eagine {
 
@@ -20,21 +24,95 @@ static auto get_base_generator(main_ctx& ctx)
 auto main(main_ctx& ctx) -> int {
     using namespace eagine;
 
-    if(auto bgen{get_base_generator(ctx)}) {
-        valid_if_positive<span_size_t> samples{256};
-        if(const auto arg{ctx.args().find("--shape-occlusion-samples")}) {
-            assign_if_fits(arg.next(), samples);
+    std::shared_ptr<shapes::generator_instrumentation> instr;
+    if(ctx.args().find("--shape-instrument")) {
+        instr = std::make_shared<shapes::generator_instrumentation>();
+    }
+
+    if(auto bgen{shapes::instrument(get_base_generator(ctx), "input", instr)}) {
+        shapes::occlusion_options occl_opts{256};
+        if(not parse_from(ctx, occl_opts)) {
+            return 1;
+        }
+        occl_opts.instrumentation = instr;
+
+        std::vector<shapes::occlusion_shard> shards;
+        std::string shard_out;
+        for(const auto arg : ctx.args()) {
+            if(arg.is_long_tag("shape-occlusion-shard-out")) {
+                shard_out = to_string(arg.next().get());
+            } else if(arg.is_long_tag("shape-occlusion-merge")) {
+                std::ifstream input{
+                  to_string(arg.next().get()), std::ios::binary};
+                if(not read_occlusion_shard(input, shards.emplace_back())) {
+                    ctx.log()
+                      .error("failed to read occlusion shard")
+                      .arg("path", arg.next().get());
+                    return 1;
+                }
+            }
+        }
+
+        // the shards contain only the occlusion values
+        if(
+          occl_opts.bent_normals and
+          (occl_opts.vertex_count or not shards.empty())) {
+            ctx.log().error(
+              "bent normals cannot be computed in occlusion shards");
+            return 1;
         }
-        if(auto gen{
-             shapes::occlude(std::move(bgen), samples.value_or(256), ctx)}) {
+        if(occl_opts.vertex_count and shard_out.empty()) {
+            ctx.log().error("missing occlusion shard output path");
+            return 1;
+        }
+
+        shared_holder<shapes::generator> gen;
+        if(shards.empty()) {
+            gen = shapes::instrument(
+              shapes::occlude(std::move(bgen), occl_opts, ctx),
+              "occlude",
+              instr);
+            if(gen and occl_opts.vertex_count) {
+                std::ofstream output{
+                  shard_out, std::ios::binary | std::ios::trunc};
+                if(not write_occlusion_shard(
+                     output, shapes::make_occlusion_shard(*gen, occl_opts))) {
+                    ctx.log()
+                      .error("failed to write occlusion shard")
+                      .arg("path", shard_out);
+                    return 1;
+                }
+                if(instr) {
+                    shapes::to_json(std::clog, *instr) << std::endl;
+                }
+                return 0;
+            }
+        } else {
+            gen = shapes::merge_occlusion_shards(std::move(bgen), view(shards));
+            if(not gen) {
+                ctx.log().error("occlusion shards do not cover the shape");
+                return 1;
+            }
+        }
+
+        if(gen) {
             shapes::to_json_options opts;
             if(parse_from(ctx, *gen, opts)) {
                 opts.attrib_variants[shapes::vertex_attrib_kind::occlusion][0];
+                if(occl_opts.bent_normals) {
+                    const auto nva{shapes::vertex_attrib_kind::normal};
+                    if(const auto bent{gen->find_variant(nva, "bent")}) {
+                        opts.attrib_variants[nva][bent.index()];
+                    }
+                }
                 shapes::to_json(std::cout, *gen, opts) << std::endl;
             }
         }
     }
 
+    if(instr) {
+        shapes::to_json(std::clog, *instr) << std::endl;
+    }
     return 0;
 }
 
@@ -8,6 +8,7 @@ import eagine.core;
 import eagine.shapes;
 import <iostream>;
 import <map>;
+import <memory>;
 
 namespace eagine {
 
@@ -41,12 +42,21 @@ static auto get_base_generator(const main_ctx& ctx) {
 auto main(main_ctx& ctx) -> int {
     using namespace eagine;
 
-    if(auto gen{get_base_generator(ctx)}) {
+    std::shared_ptr<shapes::generator_instrumentation> instr;
+    if(ctx.args().find("--shape-instrument")) {
+        instr = std::make_shared<shapes::generator_instrumentation>();
+    }
+
+    if(auto gen{shapes::instrument(get_base_generator(ctx), "shape", instr)}) {
         shapes::to_json_options opts;
         if(parse_from(ctx, *gen, opts)) {
             shapes::to_json(std::cout, *gen, opts) << std::endl;
         }
     }
+
+    if(instr) {
+        shapes::to_json(std::clog, *instr) << std::endl;
+    }
     return 0;
 }
 
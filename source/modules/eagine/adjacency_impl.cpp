@@ -23,6 +23,7 @@ public:
     triangle_adjacency_gen(
       shared_holder<generator> gen,
       const drawing_variant var,
+      std::filesystem::path topology_dir,
       main_ctx_parent parent) noexcept;
 
     auto enable(const generator_capability cap, const bool value) noexcept
@@ -51,6 +52,7 @@ private:
     template <typename T>
     void _indices(const drawing_variant, span<T> dest) noexcept;
 
+    std::filesystem::path _topology_dir;
     std::map<drawing_variant, topology> _topologies;
 };
 //------------------------------------------------------------------------------
@@ -58,7 +60,16 @@ auto add_triangle_adjacency(
   shared_holder<generator> gen,
   const drawing_variant var,
   main_ctx_parent parent) noexcept -> shared_holder<generator> {
-    return {hold<triangle_adjacency_gen>, std::move(gen), var, parent};
+    return {hold<triangle_adjacency_gen>, std::move(gen), var, "", parent};
+}
+//------------------------------------------------------------------------------
+auto add_triangle_adjacency(
+  shared_holder<generator> gen,
+  const drawing_variant var,
+  const std::filesystem::path& topology_dir,
+  main_ctx_parent parent) noexcept -> shared_holder<generator> {
+    return {
+      hold<triangle_adjacency_gen>, std::move(gen), var, topology_dir, parent};
 }
 //------------------------------------------------------------------------------
 auto triangle_adjacency_gen::_topology(const drawing_variant var) noexcept
@@ -67,9 +78,20 @@ auto triangle_adjacency_gen::_topology(const drawing_variant var) noexcept
     if(not found) {
         topology_options opts;
         opts.features = topology_feature_bit::triangle_adjacency;
-        found.emplace(
-          var,
-          topology{delegated_gen::base_generator(), opts, this->as_parent()});
+        if(_topology_dir.empty()) {
+            found.emplace(
+              var,
+              topology{
+                delegated_gen::base_generator(), opts, this->as_parent()});
+        } else {
+            found.emplace(
+              var,
+              topology{
+                delegated_gen::base_generator(),
+                opts,
+                _topology_dir,
+                this->as_parent()});
+        }
     }
     return *found;
 }
@@ -77,9 +99,11 @@ auto triangle_adjacency_gen::_topology(const drawing_variant var) noexcept
 triangle_adjacency_gen::triangle_adjacency_gen(
   shared_holder<generator> gen,
   const drawing_variant var,
+  std::filesystem::path topology_dir,
   main_ctx_parent parent) noexcept
   : main_ctx_object{"AjcyShpGen", parent}
-  , delegated_gen{std::move(gen)} {
+  , delegated_gen{std::move(gen)}
+  , _topology_dir{std::move(topology_dir)} {
     enable(generator_capability::indexed_drawing, true);
     _topology(var);
 }
@@ -131,7 +155,7 @@ void triangle_adjacency_gen::_indices(
 
     span_size_t i = 0;
     for(const auto t : integer_range(topo.triangle_count())) {
-        auto& tri = topo.triangle(t);
+        const auto tri{topo.triangle(t)};
         for(const auto v : integer_range(3)) {
             dest[i++] = limit_cast<T>(tri.vertex_index(v));
             dest[i++] = limit_cast<T>(tri.opposite_index(v));
@@ -42,6 +42,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
 private:
     std::array<float, 3> _d;
     span_size_t _copies;
@@ -220,11 +222,23 @@ auto array_gen::bounding_sphere() -> math::sphere<float> {
     using std::sqrt;
 
     const auto v = math::vector<float, 3>{_d[0], _d[1], _d[2]};
-    const auto c = float(_copies);
+    // the copies are offset by 0 to (copies - 1) times the displacement
+    const auto c = float(math::maximum(_copies - 1, span_size_t(0)));
     const auto l = length(v);
     const auto bs = delegated_gen::bounding_sphere();
 
     return {bs.center() + c * 0.5F * v, bs.radius() + c * 0.5F * l};
 }
 //------------------------------------------------------------------------------
+auto array_gen::bounding_box() -> shape_bounding_box {
+    const auto c = float(math::maximum(_copies - 1, span_size_t(0)));
+    auto bb = delegated_gen::bounding_box();
+    for(const auto k : integer_range(std_size(3))) {
+        const auto d = c * _d[k];
+        bb.min[k] += math::minimum(d, 0.F);
+        bb.max[k] += math::maximum(d, 0.F);
+    }
+    return bb;
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
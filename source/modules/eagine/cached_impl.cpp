@@ -5,6 +5,10 @@
 /// See accompanying file LICENSE_1_0.txt or copy at
 /// https://www.boost.org/LICENSE_1_0.txt
 ///
+module;
+
+#include <cassert>
+
 module eagine.shapes;
 
 import std;
@@ -17,7 +21,13 @@ class cached_gen
   , public generator {
 
 public:
-    cached_gen(shared_holder<generator> gen, main_ctx_parent parent) noexcept;
+    cached_gen(
+      shared_holder<generator> gen,
+      const cache_options& opts,
+      main_ctx_parent parent) noexcept;
+    ~cached_gen() noexcept;
+
+    auto statistics() const noexcept -> cache_statistics;
 
     auto attrib_kinds() noexcept -> vertex_attrib_kinds final {
         return _gen->attrib_kinds();
@@ -60,6 +70,27 @@ public:
     void attrib_values(const vertex_attrib_variant, span<std::uint32_t>) final;
     void attrib_values(const vertex_attrib_variant, span<float>) final;
 
+    auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<byte>) -> shared_data_view<byte> final;
+    auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<std::int16_t>) -> shared_data_view<std::int16_t> final;
+    auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<std::uint16_t>)
+      -> shared_data_view<std::uint16_t> final;
+    auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<std::int32_t>) -> shared_data_view<std::int32_t> final;
+    auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<std::uint32_t>)
+      -> shared_data_view<std::uint32_t> final;
+    auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<float>) -> shared_data_view<float> final;
+
     auto draw_variant_count() -> span_size_t final {
         return _draw_variant_count;
     }
@@ -71,13 +102,22 @@ public:
     void indices(const drawing_variant, span<std::uint16_t> dest) final;
     void indices(const drawing_variant, span<std::uint32_t> dest) final;
 
+    auto indices_view(const drawing_variant, std::type_identity<std::uint8_t>)
+      -> shared_data_view<std::uint8_t> final;
+    auto indices_view(const drawing_variant, std::type_identity<std::uint16_t>)
+      -> shared_data_view<std::uint16_t> final;
+    auto indices_view(const drawing_variant, std::type_identity<std::uint32_t>)
+      -> shared_data_view<std::uint32_t> final;
+
     auto operation_count(const drawing_variant var) -> span_size_t final;
 
     void instructions(const drawing_variant, span<draw_operation> dest) final;
+    auto instructions_view(const drawing_variant)
+      -> shared_data_view<draw_operation> final;
 
-    auto bounding_sphere() -> math::sphere<float> final {
-        return _bounding_sphere;
-    }
+    auto bounding_sphere() -> math::sphere<float> final;
+
+    auto bounding_box() -> shape_bounding_box final;
 
     void for_each_triangle(
       generator& gen,
@@ -92,90 +132,429 @@ public:
       const span<const math::line<float>> rays,
       span<optionally_valid<float>> intersections) final;
 
+    void warm_up(
+      const vertex_attrib_kinds attribs,
+      const span<const drawing_variant> vars) final;
+
 private:
     const shared_holder<generator> _gen;
     const span_size_t _instance_count;
     const span_size_t _vertex_count;
     const span_size_t _draw_variant_count;
-    const math::sphere<float> _bounding_sphere;
+    std::once_flag _bounding_sphere_once;
+    math::sphere<float> _bounding_sphere;
+    std::once_flag _bounding_box_once;
+    shape_bounding_box _bounding_box;
+
+    // The cached values are published into per-key slots, allocated when
+    // the cache is constructed and indexed directly by the attribute kind
+    // bit, attribute variant index and draw variant. Without a byte budget
+    // the values are published at most once, after that the reads take
+    // no locks and do not touch any shared reference counts. With a budget
+    // the resident values are linked into a list ordered by their last use
+    // guarded by the eviction mutex, the least recently used values are
+    // evicted and re-fetched on next use.
+    struct _lru_node {
+        _lru_node* prev{nullptr};
+        _lru_node* next{nullptr};
+        std::size_t bytes{0U};
+        std::shared_ptr<const void> resident;
+    };
+
+    template <typename T>
+    struct _data_slot {
+        std::once_flag once;
+        std::shared_ptr<const std::vector<T>> values;
+        std::mutex fetch_mutex;
+        _lru_node lru;
+    };
+
+    // the hits are counted in several counters picked by the calling thread,
+    // so that the threads reading from the cache do not share cache lines
+    struct alignas(64) _hit_counter {
+        std::atomic<span_size_t> value{0};
+    };
+
+    struct _attrib_metadata {
+        std::string name;
+        span_size_t values_per_vertex{0};
+        std::uint32_t divisor{0U};
+        attrib_data_type type{attrib_data_type::none};
+        bool is_integral{false};
+        bool is_normalized{false};
+    };
+
+    struct _attrib_slot {
+        std::once_flag metadata_once;
+        _attrib_metadata metadata;
+        std::tuple<
+          _data_slot<byte>,
+          _data_slot<std::int16_t>,
+          _data_slot<std::uint16_t>,
+          _data_slot<std::int32_t>,
+          _data_slot<std::uint32_t>,
+          _data_slot<float>>
+          values;
+    };
 
-    std::mutex _mutex;
-    std::map<vertex_attrib_kind, span_size_t> _attrib_variants;
-    std::map<vertex_attrib_variant, std::string> _variant_name;
-    std::map<vertex_attrib_variant, span_size_t> _values_per_vertex;
-    std::map<vertex_attrib_variant, std::uint32_t> _divisor;
-    std::map<vertex_attrib_variant, attrib_data_type> _attrib_type;
-    std::map<vertex_attrib_variant, bool> _is_integral;
-    std::map<vertex_attrib_variant, bool> _is_normalized;
+    struct _attrib_table {
+        span_size_t variant_count{0};
+        std::unique_ptr<_attrib_slot[]> slots;
+    };
 
-    std::map<vertex_attrib_variant, std::vector<byte>> _byte_cache;
-    std::map<vertex_attrib_variant, std::vector<std::int16_t>> _int16_cache;
-    std::map<vertex_attrib_variant, std::vector<std::uint16_t>> _uint16_cache;
-    std::map<vertex_attrib_variant, std::vector<std::int32_t>> _int32_cache;
-    std::map<vertex_attrib_variant, std::vector<std::uint32_t>> _uint32_cache;
-    std::map<vertex_attrib_variant, std::vector<float>> _float_cache;
+    struct _draw_slot {
+        std::once_flag metadata_once;
+        index_data_type index_type{index_data_type::none};
+        span_size_t index_count{0};
+        span_size_t operation_count{0};
+        std::tuple<
+          _data_slot<std::uint8_t>,
+          _data_slot<std::uint16_t>,
+          _data_slot<std::uint32_t>,
+          _data_slot<draw_operation>>
+          values;
+        std::once_flag bvh_once;
+        triangle_bvh bvh;
+    };
 
-    std::map<drawing_variant, index_data_type> _index_type;
-    std::map<drawing_variant, span_size_t> _index_count;
+    // indexed by the bit position of the vertex attribute kind
+    std::array<_attrib_table, std::size_t(vertex_attrib_kind_count())>
+      _attrib_tables;
+    const std::unique_ptr<_draw_slot[]> _draw_slots;
 
-    std::map<drawing_variant, std::vector<std::uint8_t>> _idx8_cache;
-    std::map<drawing_variant, std::vector<std::uint16_t>> _idx16_cache;
-    std::map<drawing_variant, std::vector<std::uint32_t>> _idx32_cache;
+    const std::size_t _max_bytes;
+    std::atomic<std::size_t> _bytes_resident{0U};
+    std::array<_hit_counter, 16> _hits;
+    std::atomic<span_size_t> _misses{0};
+    std::atomic<span_size_t> _evictions{0};
+    std::mutex _evict_mutex;
+    // the most recently used node follows, the least recently used one
+    // precedes this sentinel
+    _lru_node _lru;
 
-    std::map<drawing_variant, span_size_t> _operation_count;
+    using _instr_counters = generator_instrumentation::call_counters;
+    const std::shared_ptr<generator_instrumentation> _instr;
+    generator_instrumentation::node_counters* const _instr_node;
 
-    std::map<drawing_variant, std::vector<draw_operation>> _instructions;
+    template <typename Fetch>
+    auto _measure_fetch(
+      _instr_counters generator_instrumentation::node_counters::*,
+      const Fetch&);
+
+    void _count_hit() noexcept;
+    void _lru_unlink(_lru_node&) noexcept;
+    void _lru_push_front(_lru_node&) noexcept;
+    void _enforce_budget(const _lru_node& keep) noexcept;
+
+    template <typename T, typename Fetch, typename Use>
+    auto _use_cached(_data_slot<T>&, const Fetch&, const Use&);
+
+    auto _attrib_table_of(const vertex_attrib_kind) noexcept -> _attrib_table*;
+    auto _slot_of(const vertex_attrib_variant) noexcept -> _attrib_slot*;
+    auto _slot_of(const drawing_variant) noexcept -> _draw_slot*;
+
+    auto _metadata_of(_attrib_slot&, const vertex_attrib_variant)
+      -> const _attrib_metadata&;
+    auto _metadata_of(_draw_slot&, const drawing_variant) -> const _draw_slot&;
+
+    template <typename T, typename Use>
+    auto _use_values(const vertex_attrib_variant, const Use&);
 
     template <typename T>
-    void _get_values(
-      const vertex_attrib_variant,
-      span<T>,
-      std::map<vertex_attrib_variant, std::vector<T>>&);
+    void _fetch_values(const vertex_attrib_variant, span<T>);
 
     template <typename T>
-    void _get_indices(
-      const drawing_variant,
-      span<T>,
-      std::map<drawing_variant, std::vector<T>>&);
+    auto _values_view(const vertex_attrib_variant) -> shared_data_view<T>;
 
-    void _get_instructions(
-      const drawing_variant,
-      span<draw_operation>,
-      std::map<drawing_variant, std::vector<draw_operation>>&);
+    template <typename T, typename Use>
+    auto _use_indices(const drawing_variant, const Use&);
+
+    template <typename Use>
+    auto _use_instructions(const drawing_variant, const Use&);
+
+    template <typename T>
+    static auto _view_of(std::shared_ptr<const std::vector<T>> values) noexcept
+      -> shared_data_view<T> {
+        const span<const T> values_view{view(*values)};
+        return {std::move(values), values_view};
+    }
+
+    template <typename T>
+    static void _keep_values(const std::shared_ptr<const std::vector<T>>&) {}
+
+    auto _get_bvh(const drawing_variant) -> const triangle_bvh&;
+
+    void _warm_up_values(const vertex_attrib_variant);
+    void _warm_up_indices(const drawing_variant);
 };
 //------------------------------------------------------------------------------
 auto cache(shared_holder<generator> gen, main_ctx_parent parent) noexcept
   -> shared_holder<generator> {
-    return {hold<cached_gen>, std::move(gen), parent};
+    return cache(std::move(gen), cache_options{}, parent);
+}
+//------------------------------------------------------------------------------
+auto cache(
+  shared_holder<generator> gen,
+  const cache_options& opts,
+  main_ctx_parent parent) noexcept -> shared_holder<generator> {
+    shared_holder<generator> result{
+      hold<cached_gen>, std::move(gen), opts, parent};
+    if(opts.warm_up) {
+        result->warm_up();
+    }
+    return result;
+}
+//------------------------------------------------------------------------------
+auto cache_statistics_of(generator& gen) noexcept
+  -> std::optional<cache_statistics> {
+    if(const auto cached{dynamic_cast<const cached_gen*>(&gen)}) {
+        return cached->statistics();
+    }
+    return {};
 }
 //------------------------------------------------------------------------------
 cached_gen::cached_gen(
   shared_holder<generator> gen,
+  const cache_options& opts,
   main_ctx_parent parent) noexcept
   : main_ctx_object{"CchdShpGen", parent}
   , _gen{std::move(gen)}
   , _instance_count{_gen->instance_count()}
   , _vertex_count{_gen->vertex_count()}
   , _draw_variant_count{_gen->draw_variant_count()}
-  , _bounding_sphere{_gen->bounding_sphere()} {}
+  , _draw_slots{std::make_unique<_draw_slot[]>(std_size(_draw_variant_count))}
+  , _max_bytes{std_size(math::maximum(opts.max_bytes, span_size_t(0)))}
+  , _instr{opts.instrumentation}
+  , _instr_node{_instr ? &_instr->add_node("cache") : nullptr} {
+    _lru.prev = &_lru;
+    _lru.next = &_lru;
+    for(const auto bit : integer_range(_attrib_tables.size())) {
+        const auto attrib{static_cast<vertex_attrib_kind>(1U << bit)};
+        auto& table = _attrib_tables[bit];
+        table.variant_count = _gen->attribute_variants(attrib);
+        if(table.variant_count > 0) {
+            table.slots =
+              std::make_unique<_attrib_slot[]>(std_size(table.variant_count));
+        }
+    }
+}
+//------------------------------------------------------------------------------
+cached_gen::~cached_gen() noexcept {
+    const auto stats{statistics()};
+    if(stats.misses > 0) {
+        log_info("shape cache statistics")
+          .arg("hits", stats.hits)
+          .arg("misses", stats.misses)
+          .arg("evictions", stats.evictions)
+          .arg("resident", stats.bytes_resident)
+          .arg("budget", _max_bytes);
+    }
+}
+//------------------------------------------------------------------------------
+auto cached_gen::statistics() const noexcept -> cache_statistics {
+    cache_statistics result;
+    for(const auto& hits : _hits) {
+        result.hits += hits.value.load(std::memory_order_relaxed);
+    }
+    result.misses = _misses.load(std::memory_order_relaxed);
+    result.evictions = _evictions.load(std::memory_order_relaxed);
+    result.bytes_resident =
+      span_size(_bytes_resident.load(std::memory_order_relaxed));
+    return result;
+}
+//------------------------------------------------------------------------------
+void cached_gen::_count_hit() noexcept {
+    static thread_local const std::size_t shard{
+      std::hash<std::thread::id>{}(std::this_thread::get_id())};
+    _hits[shard % _hits.size()].value.fetch_add(1, std::memory_order_relaxed);
+}
+//------------------------------------------------------------------------------
+void cached_gen::_lru_unlink(_lru_node& node) noexcept {
+    node.prev->next = node.next;
+    node.next->prev = node.prev;
+    node.prev = nullptr;
+    node.next = nullptr;
+}
+//------------------------------------------------------------------------------
+void cached_gen::_lru_push_front(_lru_node& node) noexcept {
+    node.prev = &_lru;
+    node.next = _lru.next;
+    _lru.next->prev = &node;
+    _lru.next = &node;
+}
+//------------------------------------------------------------------------------
+void cached_gen::_enforce_budget(const _lru_node& keep) noexcept {
+    // the caller holds the eviction mutex, the node which has just been
+    // populated is kept even if it alone exceeds the budget
+    auto* node{_lru.prev};
+    while((_bytes_resident.load() > _max_bytes) and (node != &_lru)) {
+        auto* const prev{node->prev};
+        if(node != &keep) {
+            const auto bytes{node->bytes};
+            _lru_unlink(*node);
+            node->resident.reset();
+            node->bytes = 0U;
+            _bytes_resident -= bytes;
+            _evictions.fetch_add(1, std::memory_order_relaxed);
+            log_debug("evicted cached shape data")
+              .arg("size", bytes)
+              .arg("resident", _bytes_resident.load());
+        }
+        node = prev;
+    }
+}
+//------------------------------------------------------------------------------
+template <typename Fetch>
+auto cached_gen::_measure_fetch(
+  _instr_counters generator_instrumentation::node_counters::*counters,
+  const Fetch& fetch) {
+    if(not _instr_node) {
+        return fetch();
+    }
+    const auto start{std::chrono::steady_clock::now()};
+    auto values{fetch()};
+    (_instr_node->*counters)
+      .add(
+        span_size(values->size() * sizeof(*values->data())),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start));
+    return values;
+}
+//------------------------------------------------------------------------------
+template <typename T, typename Fetch, typename Use>
+auto cached_gen::_use_cached(
+  _data_slot<T>& slot,
+  const Fetch& fetch,
+  const Use& use) {
+    if(_max_bytes == 0U) {
+        bool fetched{false};
+        std::call_once(slot.once, [&] {
+            slot.values = fetch();
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            _bytes_resident += slot.values->size() * sizeof(T);
+            fetched = true;
+        });
+        if(not fetched) {
+            _count_hit();
+        }
+        const auto& values = slot.values;
+        return use(values);
+    }
+
+    using values_ptr = std::shared_ptr<const std::vector<T>>;
+    const auto get_resident{[&]() -> values_ptr {
+        const std::lock_guard<std::mutex> lock{_evict_mutex};
+        if(slot.lru.resident) {
+            _lru_unlink(slot.lru);
+            _lru_push_front(slot.lru);
+            return std::static_pointer_cast<const std::vector<T>>(
+              slot.lru.resident);
+        }
+        return {};
+    }};
+
+    values_ptr values{get_resident()};
+    if(values) {
+        _count_hit();
+    } else {
+        // the values of a slot are fetched by one thread at a time
+        const std::lock_guard<std::mutex> fetch_lock{slot.fetch_mutex};
+        values = get_resident();
+        if(values) {
+            _count_hit();
+        } else {
+            values = fetch();
+            const std::lock_guard<std::mutex> lock{_evict_mutex};
+            slot.lru.bytes = values->size() * sizeof(T);
+            slot.lru.resident = values;
+            _lru_push_front(slot.lru);
+            _bytes_resident += slot.lru.bytes;
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            _enforce_budget(slot.lru);
+        }
+    }
+    return use(values);
+}
+//------------------------------------------------------------------------------
+auto cached_gen::_attrib_table_of(const vertex_attrib_kind attrib) noexcept
+  -> _attrib_table* {
+    const auto bit{std_size(std::countr_zero(std::uint32_t(attrib)))};
+    if(bit < _attrib_tables.size()) {
+        return &_attrib_tables[bit];
+    }
+    return nullptr;
+}
+//------------------------------------------------------------------------------
+auto cached_gen::_slot_of(const vertex_attrib_variant vav) noexcept
+  -> _attrib_slot* {
+    if(const auto table{_attrib_table_of(vav.attribute())}) {
+        if(vav.has_valid_index() and (vav.index() < table->variant_count)) {
+            return &table->slots[std_size(vav.index())];
+        }
+    }
+    return nullptr;
+}
+//------------------------------------------------------------------------------
+auto cached_gen::_slot_of(const drawing_variant var) noexcept -> _draw_slot* {
+    if((var >= 0) and (var < _draw_variant_count)) {
+        return &_draw_slots[std_size(var)];
+    }
+    return nullptr;
+}
+//------------------------------------------------------------------------------
+auto cached_gen::_metadata_of(
+  _attrib_slot& slot,
+  const vertex_attrib_variant vav) -> const _attrib_metadata& {
+    std::call_once(slot.metadata_once, [&] {
+        auto& metadata = slot.metadata;
+        metadata.name = to_string(_gen->variant_name(vav));
+        metadata.values_per_vertex = _gen->values_per_vertex(vav);
+        metadata.divisor = _gen->attrib_divisor(vav);
+        metadata.type = _gen->attrib_type(vav);
+        metadata.is_integral = _gen->is_attrib_integral(vav);
+        metadata.is_normalized = _gen->is_attrib_normalized(vav);
+    });
+    return slot.metadata;
+}
+//------------------------------------------------------------------------------
+auto cached_gen::_metadata_of(_draw_slot& slot, const drawing_variant var)
+  -> const _draw_slot& {
+    std::call_once(slot.metadata_once, [&] {
+        slot.index_type = _gen->index_type(var);
+        slot.index_count = _gen->index_count(var);
+        slot.operation_count = _gen->operation_count(var);
+    });
+    return slot;
+}
+//------------------------------------------------------------------------------
+auto cached_gen::bounding_sphere() -> math::sphere<float> {
+    // computing the bounds may require scanning all vertex positions,
+    // so it is deferred until somebody actually asks for them
+    std::call_once(_bounding_sphere_once, [this] {
+        _bounding_sphere = _gen->bounding_sphere();
+    });
+    return _bounding_sphere;
+}
+//------------------------------------------------------------------------------
+auto cached_gen::bounding_box() -> shape_bounding_box {
+    std::call_once(
+      _bounding_box_once, [this] { _bounding_box = _gen->bounding_box(); });
+    return _bounding_box;
+}
 //------------------------------------------------------------------------------
 auto cached_gen::attribute_variants(const vertex_attrib_kind attrib)
   -> span_size_t {
-    const std::lock_guard<std::mutex> lock{_mutex};
-    auto found{find(_attrib_variants, attrib)};
-    if(not found) {
-        found.emplace(attrib, _gen->attribute_variants(attrib));
+    if(const auto table{_attrib_table_of(attrib)}) {
+        return table->variant_count;
     }
-    return *found;
+    return _gen->attribute_variants(attrib);
 }
 //------------------------------------------------------------------------------
 auto cached_gen::variant_name(const vertex_attrib_variant vav) -> string_view {
-    const std::lock_guard<std::mutex> lock{_mutex};
-    auto found{find(_variant_name, vav)};
-    if(not found) {
-        found.emplace(vav, to_string(_gen->variant_name(vav)));
+    if(const auto slot{_slot_of(vav)}) {
+        return {_metadata_of(*slot, vav).name};
     }
-    return {*found};
+    return _gen->variant_name(vav);
 }
 //------------------------------------------------------------------------------
 auto cached_gen::find_variant(
@@ -186,12 +565,10 @@ auto cached_gen::find_variant(
 //------------------------------------------------------------------------------
 auto cached_gen::values_per_vertex(const vertex_attrib_variant vav)
   -> span_size_t {
-    const std::lock_guard<std::mutex> lock{_mutex};
-    auto found{find(_values_per_vertex, vav)};
-    if(not found) {
-        found.emplace(vav, _gen->values_per_vertex(vav));
+    if(const auto slot{_slot_of(vav)}) {
+        return _metadata_of(*slot, vav).values_per_vertex;
     }
-    return *found;
+    return _gen->values_per_vertex(vav);
 }
 //------------------------------------------------------------------------------
 auto cached_gen::value_count(const vertex_attrib_variant vav) -> span_size_t {
@@ -200,185 +577,353 @@ auto cached_gen::value_count(const vertex_attrib_variant vav) -> span_size_t {
 //------------------------------------------------------------------------------
 auto cached_gen::attrib_type(const vertex_attrib_variant vav)
   -> attrib_data_type {
-    const std::lock_guard<std::mutex> lock{_mutex};
-    auto found{find(_attrib_type, vav)};
-    if(not found) {
-        found.emplace(vav, _gen->attrib_type(vav));
+    if(const auto slot{_slot_of(vav)}) {
+        return _metadata_of(*slot, vav).type;
     }
-    return *found;
+    return _gen->attrib_type(vav);
 }
 //------------------------------------------------------------------------------
 auto cached_gen::is_attrib_integral(const vertex_attrib_variant vav) -> bool {
-    const std::lock_guard<std::mutex> lock{_mutex};
-    auto found{find(_is_integral, vav)};
-    if(not found) {
-        found.emplace(vav, _gen->is_attrib_integral(vav));
+    if(const auto slot{_slot_of(vav)}) {
+        return _metadata_of(*slot, vav).is_integral;
     }
-    return *found;
+    return _gen->is_attrib_integral(vav);
 }
 //------------------------------------------------------------------------------
 auto cached_gen::is_attrib_normalized(const vertex_attrib_variant vav) -> bool {
-    const std::lock_guard<std::mutex> lock{_mutex};
-    auto found{find(_is_normalized, vav)};
-    if(not found) {
-        found.emplace(vav, _gen->is_attrib_normalized(vav));
+    if(const auto slot{_slot_of(vav)}) {
+        return _metadata_of(*slot, vav).is_normalized;
     }
-    return *found;
+    return _gen->is_attrib_normalized(vav);
 }
 //------------------------------------------------------------------------------
 auto cached_gen::attrib_divisor(const vertex_attrib_variant vav)
   -> std::uint32_t {
-    const std::lock_guard<std::mutex> lock{_mutex};
-    auto found{find(_divisor, vav)};
-    if(not found) {
-        found.emplace(vav, _gen->attrib_divisor(vav));
+    if(const auto slot{_slot_of(vav)}) {
+        return _metadata_of(*slot, vav).divisor;
     }
-    return *found;
+    return _gen->attrib_divisor(vav);
 }
 //------------------------------------------------------------------------------
 auto cached_gen::index_type(const drawing_variant var) -> index_data_type {
-    const std::lock_guard<std::mutex> lock{_mutex};
-    auto found{find(_index_type, var)};
-    if(not found) {
-        found.emplace(var, _gen->index_type(var));
+    if(const auto slot{_slot_of(var)}) {
+        return _metadata_of(*slot, var).index_type;
     }
-    return *found;
+    return _gen->index_type(var);
 }
 //------------------------------------------------------------------------------
 auto cached_gen::index_count(const drawing_variant var) -> span_size_t {
-    const std::lock_guard<std::mutex> lock{_mutex};
-    auto found{find(_index_count, var)};
-    if(not found) {
-        found.emplace(var, _gen->index_count(var));
+    if(const auto slot{_slot_of(var)}) {
+        return _metadata_of(*slot, var).index_count;
     }
-    return *found;
+    return _gen->index_count(var);
 }
 //------------------------------------------------------------------------------
 auto cached_gen::operation_count(const drawing_variant var) -> span_size_t {
-    const std::lock_guard<std::mutex> lock{_mutex};
-    auto found{find(_operation_count, var)};
-    if(not found) {
-        found.emplace(var, _gen->operation_count(var));
+    if(const auto slot{_slot_of(var)}) {
+        return _metadata_of(*slot, var).operation_count;
+    }
+    return _gen->operation_count(var);
+}
+//------------------------------------------------------------------------------
+template <typename T, typename Use>
+auto cached_gen::_use_values(const vertex_attrib_variant vav, const Use& use) {
+    const auto fetch{[&] {
+        return _measure_fetch(
+          &generator_instrumentation::node_counters::attrib_values,
+          [&]() -> std::shared_ptr<const std::vector<T>> {
+              auto values{
+                std::make_shared<std::vector<T>>(std_size(value_count(vav)))};
+              _gen->attrib_values(vav, cover(*values));
+              return values;
+          });
+    }};
+    if(const auto slot{_slot_of(vav)}) {
+        return _use_cached(
+          std::get<_data_slot<T>>(slot->values),
+          [&] {
+              auto values{fetch()};
+              log_debug("cached attribute values")
+                .arg("attrib", vav.attribute())
+                .arg("index", vav.index())
+                .arg("size", values->size());
+              return values;
+          },
+          use);
+    }
+    return use(fetch());
+}
+//------------------------------------------------------------------------------
+// Converts the values with saturation of the integral target types.
+// The loops are kept simple so that the compiler can vectorize them.
+template <typename D, typename S>
+static void convert_attrib_values(
+  const span<const S> source,
+  span<D> dest) noexcept {
+    assert(dest.size() >= source.size());
+    const auto count{std_size(source.size())};
+    const S* src{source.data()};
+    D* dst{dest.data()};
+    if constexpr(std::is_same_v<S, D>) {
+        std::copy(src, src + count, dst);
+    } else if constexpr(std::is_integral_v<D>) {
+        constexpr const auto lo{double(std::numeric_limits<D>::lowest())};
+        constexpr const auto hi{double(std::numeric_limits<D>::max())};
+        for(std::size_t i = 0; i < count; ++i) {
+            const auto v{double(src[i])};
+            // NaNs are converted to zeros
+            dst[i] = static_cast<D>(v == v ? std::clamp(v, lo, hi) : 0.0);
+        }
+    } else {
+        for(std::size_t i = 0; i < count; ++i) {
+            dst[i] = static_cast<D>(src[i]);
+        }
     }
-    return *found;
 }
 //------------------------------------------------------------------------------
 template <typename T>
-void cached_gen::_get_values(
+void cached_gen::_fetch_values(
   const vertex_attrib_variant vav,
-  span<T> dest,
-  std::map<vertex_attrib_variant, std::vector<T>>& cache) {
-    const auto& src{[this, vav, &cache]() -> const std::vector<T>& {
-        const auto size = std_size(value_count(vav));
-        const std::lock_guard<std::mutex> lock{_mutex};
-        auto& cached = cache[vav];
-        if(cached.empty()) {
-            cached.resize(size);
-            _gen->attrib_values(vav, cover(cached));
-            log_debug("cached attribute values")
-              .arg("attrib", vav.attribute())
-              .arg("index", vav.index())
-              .arg("size", size);
-        }
-        return cached;
-    }()};
-    copy(view(src), dest);
+  span<T> dest) {
+    // each attribute is fetched and cached only in its native data type,
+    // the values requested in other types are converted from that copy
+    const auto convert_from{[&]<typename S>(std::type_identity<S>) {
+        _use_values<S>(vav, [&](const auto& values) {
+            convert_attrib_values(view(*values), dest);
+        });
+    }};
+    switch(attrib_type(vav)) {
+        case attrib_data_type::ubyte:
+            convert_from(std::type_identity<byte>{});
+            break;
+        case attrib_data_type::int_16:
+            convert_from(std::type_identity<std::int16_t>{});
+            break;
+        case attrib_data_type::int_32:
+            convert_from(std::type_identity<std::int32_t>{});
+            break;
+        case attrib_data_type::uint_16:
+            convert_from(std::type_identity<std::uint16_t>{});
+            break;
+        case attrib_data_type::uint_32:
+            convert_from(std::type_identity<std::uint32_t>{});
+            break;
+        case attrib_data_type::float_:
+            convert_from(std::type_identity<float>{});
+            break;
+        case attrib_data_type::none:
+            _use_values<T>(
+              vav, [&](const auto& values) { copy(view(*values), dest); });
+            break;
+    }
 }
 //------------------------------------------------------------------------------
 template <typename T>
-void cached_gen::_get_indices(
-  const drawing_variant var,
-  span<T> dest,
-  std::map<drawing_variant, std::vector<T>>& cache) {
-    const auto& src{[this, var, &cache]() -> const std::vector<T>& {
-        const auto size = std_size(index_count(var));
-        const std::lock_guard<std::mutex> lock{_mutex};
-        auto& cached = cache[var];
-        if(cached.empty() and size != 0U) {
-            cached.resize(size);
-            _gen->indices(var, cover(cached));
-            log_debug("cached vertex indices")
-              .arg("variant", var)
-              .arg("size", size);
-        }
-        return cached;
-    }()};
-    copy(view(src), dest);
+auto cached_gen::_values_view(const vertex_attrib_variant vav)
+  -> shared_data_view<T> {
+    const auto native{attrib_type(vav)};
+    if(
+      (native == attrib_data_type_of<T>()) or
+      (native == attrib_data_type::none)) {
+        return _use_values<T>(vav, _view_of<T>);
+    }
+    return {};
 }
 //------------------------------------------------------------------------------
-void cached_gen::_get_instructions(
-  const drawing_variant var,
-  span<draw_operation> dest,
-  std::map<drawing_variant, std::vector<draw_operation>>& cache) {
-    const auto& src =
-      [this, var, &cache]() -> const std::vector<draw_operation>& {
-        const auto size = std_size(operation_count(var));
-        const std::lock_guard<std::mutex> lock{_mutex};
-        auto& cached = cache[var];
-        if(cached.empty()) {
-            cached.resize(size);
-            _gen->instructions(var, cover(cached));
-            log_debug("cached draw instructions")
-              .arg("variant", var)
-              .arg("size", size);
+template <typename T, typename Use>
+auto cached_gen::_use_indices(const drawing_variant var, const Use& use) {
+    const auto fetch{[&] {
+        return _measure_fetch(
+          &generator_instrumentation::node_counters::indices,
+          [&]() -> std::shared_ptr<const std::vector<T>> {
+              auto values{
+                std::make_shared<std::vector<T>>(std_size(index_count(var)))};
+              if(not values->empty()) {
+                  _gen->indices(var, cover(*values));
+              }
+              return values;
+          });
+    }};
+    if(const auto slot{_slot_of(var)}) {
+        return _use_cached(
+          std::get<_data_slot<T>>(slot->values),
+          [&] {
+              auto values{fetch()};
+              if(not values->empty()) {
+                  log_debug("cached vertex indices")
+                    .arg("variant", var)
+                    .arg("size", values->size());
+              }
+              return values;
+          },
+          use);
+    }
+    return use(fetch());
+}
+//------------------------------------------------------------------------------
+template <typename Use>
+auto cached_gen::_use_instructions(const drawing_variant var, const Use& use) {
+    const auto fetch{[&] {
+        return _measure_fetch(
+          &generator_instrumentation::node_counters::instructions,
+          [&]() -> std::shared_ptr<const std::vector<draw_operation>> {
+              auto values{std::make_shared<std::vector<draw_operation>>(
+                std_size(operation_count(var)))};
+              _gen->instructions(var, cover(*values));
+              return values;
+          });
+    }};
+    if(const auto slot{_slot_of(var)}) {
+        auto& cached = std::get<_data_slot<draw_operation>>(slot->values);
+        return _use_cached(
+          cached,
+          [&] {
+              auto values{fetch()};
+              log_debug("cached draw instructions")
+                .arg("variant", var)
+                .arg("size", values->size());
+              return values;
+          },
+          use);
+    }
+    return use(fetch());
+}
+//------------------------------------------------------------------------------
+auto cached_gen::_get_bvh(const drawing_variant var) -> const triangle_bvh& {
+    auto slot{_slot_of(var)};
+    assert(slot);
+    std::call_once(slot->bvh_once, [&] {
+        slot->bvh = triangle_bvh{*this, var};
+        // the hierarchy is not evicted but counts against the budget
+        _bytes_resident += std_size(slot->bvh.byte_size());
+        if(_max_bytes > 0U) {
+            const std::lock_guard<std::mutex> lock{_evict_mutex};
+            _enforce_budget(_lru);
         }
-        return cached;
-    }();
-    copy(view(src), dest);
+        log_debug("built triangle bounding volume hierarchy")
+          .arg("variant", var)
+          .arg("triangles", slot->bvh.triangle_count())
+          .arg("nodes", slot->bvh.node_count())
+          .arg("size", slot->bvh.byte_size());
+    });
+    return slot->bvh;
 }
 //------------------------------------------------------------------------------
 void cached_gen::attrib_values(
   const vertex_attrib_variant vav,
   span<byte> dest) {
-    _get_values(vav, dest, _byte_cache);
+    _fetch_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+auto cached_gen::attrib_values_view(
+  const vertex_attrib_variant vav,
+  std::type_identity<byte>) -> shared_data_view<byte> {
+    return _values_view<byte>(vav);
 }
 //------------------------------------------------------------------------------
 void cached_gen::attrib_values(
   const vertex_attrib_variant vav,
   span<std::int16_t> dest) {
-    _get_values(vav, dest, _int16_cache);
+    _fetch_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+auto cached_gen::attrib_values_view(
+  const vertex_attrib_variant vav,
+  std::type_identity<std::int16_t>) -> shared_data_view<std::int16_t> {
+    return _values_view<std::int16_t>(vav);
 }
 //------------------------------------------------------------------------------
 void cached_gen::attrib_values(
   const vertex_attrib_variant vav,
   span<std::uint16_t> dest) {
-    _get_values(vav, dest, _uint16_cache);
+    _fetch_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+auto cached_gen::attrib_values_view(
+  const vertex_attrib_variant vav,
+  std::type_identity<std::uint16_t>) -> shared_data_view<std::uint16_t> {
+    return _values_view<std::uint16_t>(vav);
 }
 //------------------------------------------------------------------------------
 void cached_gen::attrib_values(
   const vertex_attrib_variant vav,
   span<std::int32_t> dest) {
-    _get_values(vav, dest, _int32_cache);
+    _fetch_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+auto cached_gen::attrib_values_view(
+  const vertex_attrib_variant vav,
+  std::type_identity<std::int32_t>) -> shared_data_view<std::int32_t> {
+    return _values_view<std::int32_t>(vav);
 }
 //------------------------------------------------------------------------------
 void cached_gen::attrib_values(
   const vertex_attrib_variant vav,
   span<std::uint32_t> dest) {
-    _get_values(vav, dest, _uint32_cache);
+    _fetch_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+auto cached_gen::attrib_values_view(
+  const vertex_attrib_variant vav,
+  std::type_identity<std::uint32_t>) -> shared_data_view<std::uint32_t> {
+    return _values_view<std::uint32_t>(vav);
 }
 //------------------------------------------------------------------------------
 void cached_gen::attrib_values(
   const vertex_attrib_variant vav,
   span<float> dest) {
-    _get_values(vav, dest, _float_cache);
+    _fetch_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+auto cached_gen::attrib_values_view(
+  const vertex_attrib_variant vav,
+  std::type_identity<float>) -> shared_data_view<float> {
+    return _values_view<float>(vav);
 }
 //------------------------------------------------------------------------------
 void cached_gen::indices(const drawing_variant var, span<std::uint8_t> dest) {
-    _get_indices(var, dest, _idx8_cache);
+    _use_indices<std::uint8_t>(
+      var, [&](const auto& values) { copy(view(*values), dest); });
+}
+//------------------------------------------------------------------------------
+auto cached_gen::indices_view(
+  const drawing_variant var,
+  std::type_identity<std::uint8_t>) -> shared_data_view<std::uint8_t> {
+    return _use_indices<std::uint8_t>(var, _view_of<std::uint8_t>);
 }
 //------------------------------------------------------------------------------
 void cached_gen::indices(const drawing_variant var, span<std::uint16_t> dest) {
-    _get_indices(var, dest, _idx16_cache);
+    _use_indices<std::uint16_t>(
+      var, [&](const auto& values) { copy(view(*values), dest); });
+}
+//------------------------------------------------------------------------------
+auto cached_gen::indices_view(
+  const drawing_variant var,
+  std::type_identity<std::uint16_t>) -> shared_data_view<std::uint16_t> {
+    return _use_indices<std::uint16_t>(var, _view_of<std::uint16_t>);
 }
 //------------------------------------------------------------------------------
 void cached_gen::indices(const drawing_variant var, span<std::uint32_t> dest) {
-    _get_indices(var, dest, _idx32_cache);
+    _use_indices<std::uint32_t>(
+      var, [&](const auto& values) { copy(view(*values), dest); });
+}
+//------------------------------------------------------------------------------
+auto cached_gen::indices_view(
+  const drawing_variant var,
+  std::type_identity<std::uint32_t>) -> shared_data_view<std::uint32_t> {
+    return _use_indices<std::uint32_t>(var, _view_of<std::uint32_t>);
 }
 //------------------------------------------------------------------------------
 void cached_gen::instructions(
   const drawing_variant var,
   span<draw_operation> dest) {
-    _get_instructions(var, dest, _instructions);
+    _use_instructions(
+      var, [&](const auto& values) { copy(view(*values), dest); });
+}
+//------------------------------------------------------------------------------
+auto cached_gen::instructions_view(const drawing_variant var)
+  -> shared_data_view<draw_operation> {
+    return _use_instructions(var, _view_of<draw_operation>);
 }
 //------------------------------------------------------------------------------
 void cached_gen::for_each_triangle(
@@ -397,7 +942,102 @@ void cached_gen::ray_intersections(
   const drawing_variant var,
   const span<const math::line<float>> rays,
   span<optionally_valid<float>> intersections) {
-    _gen->ray_intersections(gen, var, rays, intersections);
+    if((&gen == this) and _slot_of(var)) {
+        const auto start{std::chrono::steady_clock::now()};
+        _get_bvh(var).ray_intersections(rays, intersections);
+        if(_instr_node) {
+            _instr_node->ray_intersections.add_rays(
+              rays.size(),
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start));
+        }
+    } else {
+        _gen->ray_intersections(gen, var, rays, intersections);
+    }
+}
+//------------------------------------------------------------------------------
+void cached_gen::_warm_up_values(const vertex_attrib_variant vav) {
+    switch(attrib_type(vav)) {
+        case attrib_data_type::ubyte:
+            _use_values<byte>(vav, _keep_values<byte>);
+            break;
+        case attrib_data_type::int_16:
+            _use_values<std::int16_t>(vav, _keep_values<std::int16_t>);
+            break;
+        case attrib_data_type::int_32:
+            _use_values<std::int32_t>(vav, _keep_values<std::int32_t>);
+            break;
+        case attrib_data_type::uint_16:
+            _use_values<std::uint16_t>(vav, _keep_values<std::uint16_t>);
+            break;
+        case attrib_data_type::uint_32:
+            _use_values<std::uint32_t>(vav, _keep_values<std::uint32_t>);
+            break;
+        case attrib_data_type::float_:
+            _use_values<float>(vav, _keep_values<float>);
+            break;
+        case attrib_data_type::none:
+            break;
+    }
+}
+//------------------------------------------------------------------------------
+void cached_gen::_warm_up_indices(const drawing_variant var) {
+    switch(index_type(var)) {
+        case index_data_type::unsigned_8:
+            _use_indices<std::uint8_t>(var, _keep_values<std::uint8_t>);
+            break;
+        case index_data_type::unsigned_16:
+            _use_indices<std::uint16_t>(var, _keep_values<std::uint16_t>);
+            break;
+        case index_data_type::unsigned_32:
+            _use_indices<std::uint32_t>(var, _keep_values<std::uint32_t>);
+            break;
+        case index_data_type::none:
+            break;
+    }
+}
+//------------------------------------------------------------------------------
+void cached_gen::warm_up(
+  const vertex_attrib_kinds attribs,
+  const span<const drawing_variant> vars) {
+    // each attribute variant, index list and instruction list is a separate
+    // task, populating only its own slot, so the tasks do not wait on
+    // each other and the cache is ready after the slowest of them
+    std::vector<std::function<void()>> tasks;
+    for(const auto& info : enumerators<vertex_attrib_kind>()) {
+        const auto attrib{info.enumerator};
+        if(attribs.has(attrib) and has(attrib)) {
+            for(const auto v : integer_range(attribute_variants(attrib))) {
+                const vertex_attrib_variant vav{attrib, v};
+                tasks.emplace_back([this, vav] { _warm_up_values(vav); });
+            }
+        }
+    }
+    for(const auto var : vars) {
+        if(_slot_of(var)) {
+            tasks.emplace_back([this, var] { _warm_up_indices(var); });
+            tasks.emplace_back([this, var] {
+                _use_instructions(var, _keep_values<draw_operation>);
+            });
+        }
+    }
+
+    std::atomic<std::size_t> next_task{0U};
+    const auto make_worker{[&] {
+        return [&]() -> bool {
+            for(auto t{next_task++}; t < tasks.size(); t = next_task++) {
+                tasks[t]();
+            }
+            return true;
+        };
+    }};
+    {
+        const inplace_work_batch warming{workers(), make_worker()};
+        make_worker()();
+    }
+    log_debug("warmed up shape cache")
+      .arg("tasks", tasks.size())
+      .arg("resident", _bytes_resident.load());
 }
 //------------------------------------------------------------------------------
 } // namespace eagine::shapes
@@ -0,0 +1,394 @@
+/// @file
+///
+/// Copyright Matus Chochlik.
+/// Distributed under the Boost Software License, Version 1.0.
+/// See accompanying file LICENSE_1_0.txt or copy at
+/// https://www.boost.org/LICENSE_1_0.txt
+///
+
+#include <eagine/testing/unit_begin_ctx.hpp>
+import std;
+import eagine.core;
+import eagine.shapes;
+//------------------------------------------------------------------------------
+void cached_same_values(auto& s) {
+    eagitest::case_ test{s, 1, "same values"};
+    using eagine::shapes::vertex_attrib_kind;
+
+    auto orig{eagine::shapes::unit_torus(
+      vertex_attrib_kind::position | vertex_attrib_kind::normal)};
+    auto cached{eagine::shapes::cache(orig, s.context())};
+    test.ensure(bool(cached), "has generator");
+    test.check(cached->vertex_count() == orig->vertex_count(), "vertex count");
+
+    for(const auto attrib :
+        {vertex_attrib_kind::position, vertex_attrib_kind::normal}) {
+        std::vector<float> expected(std::size_t(orig->value_count(attrib)));
+        orig->attrib_values(attrib, eagine::cover(expected));
+        std::vector<float> values(expected.size());
+        cached->attrib_values(attrib, eagine::cover(values));
+        test.check(values == expected, "same values");
+        std::fill(values.begin(), values.end(), 0.F);
+        cached->attrib_values(attrib, eagine::cover(values));
+        test.check(values == expected, "same cached values");
+    }
+
+    const auto stats{eagine::shapes::cache_statistics_of(*cached)};
+    test.ensure(bool(stats), "has statistics");
+    test.check(stats->misses == 2, "misses");
+    test.check(stats->hits == 2, "hits");
+    test.check(stats->evictions == 0, "no evictions");
+    test.check(not eagine::shapes::cache_statistics_of(*orig), "not cached");
+}
+//------------------------------------------------------------------------------
+void cached_eviction(auto& s) {
+    eagitest::case_ test{s, 2, "eviction"};
+    using eagine::shapes::vertex_attrib_kind;
+
+    auto orig{eagine::shapes::unit_torus(
+      vertex_attrib_kind::position | vertex_attrib_kind::normal)};
+    const auto buffer_size{orig->value_count(vertex_attrib_kind::position) *
+                           eagine::span_size(sizeof(float))};
+
+    eagine::shapes::cache_options opts;
+    opts.max_bytes = buffer_size + buffer_size / 2;
+    auto cached{eagine::shapes::cache(orig, opts, s.context())};
+    test.ensure(bool(cached), "has generator");
+
+    std::vector<float> expected(std::size_t(
+      orig->value_count(vertex_attrib_kind::position)));
+    orig->attrib_values(vertex_attrib_kind::position, eagine::cover(expected));
+
+    std::vector<float> values(expected.size());
+    cached->attrib_values(vertex_attrib_kind::position, eagine::cover(values));
+    cached->attrib_values(vertex_attrib_kind::normal, eagine::cover(values));
+    cached->attrib_values(vertex_attrib_kind::position, eagine::cover(values));
+    test.check(values == expected, "same values after eviction");
+
+    const auto stats{eagine::shapes::cache_statistics_of(*cached)};
+    test.ensure(bool(stats), "has statistics");
+    test.check(stats->misses == 3, "misses");
+    test.check(stats->evictions == 2, "evictions");
+    test.check(stats->bytes_resident <= opts.max_bytes, "within budget");
+
+    // a buffer larger than the whole budget stays until something else
+    // is fetched, instead of being evicted right away
+    opts.max_bytes = buffer_size / 2;
+    auto small{eagine::shapes::cache(orig, opts, s.context())};
+    small->attrib_values(vertex_attrib_kind::position, eagine::cover(values));
+    small->attrib_values(vertex_attrib_kind::position, eagine::cover(values));
+    test.check(values == expected, "same values over budget");
+    const auto small_stats{eagine::shapes::cache_statistics_of(*small)};
+    test.ensure(bool(small_stats), "has small statistics");
+    test.check(small_stats->misses == 1, "kept over budget");
+    test.check(small_stats->hits == 1, "hit over budget");
+    test.check(small_stats->evictions == 0, "not evicted");
+    test.check(small_stats->bytes_resident == buffer_size, "resident");
+}
+//------------------------------------------------------------------------------
+void cached_shared_shape(auto& s) {
+    eagitest::case_ test{s, 3, "shared shape"};
+    using eagine::shapes::vertex_attrib_kind;
+
+    auto a{eagine::shapes::shared_shape_from(
+      eagine::url{"shape:///unit_torus?position=0&normal=0"}, s.context())};
+    auto b{eagine::shapes::shared_shape_from(
+      eagine::url{"shape:///unit_torus?normal=0&position=0"}, s.context())};
+    auto c{eagine::shapes::shared_shape_from(
+      eagine::url{"shape:///unit_torus?position=0"}, s.context())};
+    test.ensure(bool(a), "has a");
+    test.ensure(bool(b), "has b");
+    test.ensure(bool(c), "has c");
+
+    const auto va{eagine::shapes::shared_attrib_values<float>(
+      *a, vertex_attrib_kind::position)};
+    const auto vb{eagine::shapes::shared_attrib_values<float>(
+      *b, vertex_attrib_kind::position)};
+    const auto vc{eagine::shapes::shared_attrib_values<float>(
+      *c, vertex_attrib_kind::position)};
+    test.check(not va.empty(), "has values");
+    test.check(va.values().data() == vb.values().data(), "same storage");
+    test.check(va.values().data() != vc.values().data(), "other storage");
+
+    const auto cap{eagine::shapes::generator_capability::indexed_drawing};
+    const bool enabled{b->is_enabled(cap)};
+    test.check(not a->enable(cap, not enabled), "cannot change capability");
+    test.check(a->enable(cap, enabled), "keeps capability");
+    test.check(b->is_enabled(cap) == enabled, "capability not changed");
+}
+//------------------------------------------------------------------------------
+void cached_conversion(auto& s) {
+    eagitest::case_ test{s, 4, "conversion"};
+    using eagine::shapes::vertex_attrib_kind;
+
+    auto orig{eagine::shapes::scale(
+      eagine::shapes::unit_cube(vertex_attrib_kind::position),
+      {100.F, 200.F, 300.F})};
+    auto cached{eagine::shapes::cache(orig, s.context())};
+    test.ensure(bool(cached), "has generator");
+
+    const auto count{
+      std::size_t(cached->value_count(vertex_attrib_kind::position))};
+    std::vector<float> floats(count);
+    std::vector<std::int16_t> shorts(count);
+    std::vector<std::int32_t> ints(count);
+    cached->attrib_values(vertex_attrib_kind::position, eagine::cover(floats));
+    cached->attrib_values(vertex_attrib_kind::position, eagine::cover(shorts));
+    cached->attrib_values(vertex_attrib_kind::position, eagine::cover(ints));
+
+    for(const auto i : eagine::integer_range(count)) {
+        test.check(shorts[i] == std::int16_t(floats[i]), "same short");
+        test.check(ints[i] == std::int32_t(floats[i]), "same int");
+    }
+
+    const auto stats{eagine::shapes::cache_statistics_of(*cached)};
+    test.ensure(bool(stats), "has statistics");
+    test.check(stats->misses == 1, "fetched once");
+}
+//------------------------------------------------------------------------------
+void cached_warm_up(auto& s) {
+    eagitest::case_ test{s, 5, "warm-up"};
+    using eagine::shapes::vertex_attrib_kind;
+
+    eagine::shapes::cache_options opts;
+    opts.warm_up = true;
+    auto cached{eagine::shapes::cache(
+      eagine::shapes::unit_sphere(
+        vertex_attrib_kind::position | vertex_attrib_kind::normal),
+      opts,
+      s.context())};
+    test.ensure(bool(cached), "has generator");
+
+    const auto warm{eagine::shapes::cache_statistics_of(*cached)};
+    test.ensure(bool(warm), "has statistics");
+    test.check(warm->misses >= 3, "populated");
+    test.check(warm->bytes_resident > 0, "resident");
+
+    std::vector<float> values(
+      std::size_t(cached->value_count(vertex_attrib_kind::normal)));
+    cached->attrib_values(vertex_attrib_kind::normal, eagine::cover(values));
+
+    const auto used{eagine::shapes::cache_statistics_of(*cached)};
+    test.ensure(bool(used), "has statistics");
+    test.check(used->misses == warm->misses, "no new misses");
+    test.check(used->hits > warm->hits, "hit");
+}
+//------------------------------------------------------------------------------
+void cached_instrumentation(auto& s) {
+    eagitest::case_ test{s, 6, "instrumentation"};
+    using eagine::shapes::vertex_attrib_kind;
+
+    auto instr{std::make_shared<eagine::shapes::generator_instrumentation>()};
+    auto gen{eagine::shapes::instrument(
+      eagine::shapes::cache(
+        eagine::shapes::instrument(
+          eagine::shapes::unit_torus(vertex_attrib_kind::position),
+          "torus",
+          instr),
+        s.context()),
+      "cache",
+      instr)};
+    test.ensure(bool(gen), "has generator");
+
+    const auto count{
+      std::size_t(gen->value_count(vertex_attrib_kind::position))};
+    std::vector<float> values(count);
+    gen->attrib_values(vertex_attrib_kind::position, eagine::cover(values));
+    gen->attrib_values(vertex_attrib_kind::position, eagine::cover(values));
+
+    const auto report{instr->report()};
+    test.ensure(report.size() == 2, "node count");
+    test.check(report[0].name == "torus", "inner name");
+    test.check(report[1].name == "cache", "outer name");
+    test.check(report[0].attrib_values.call_count == 1, "generated once");
+    test.check(report[1].attrib_values.call_count == 2, "requested twice");
+    test.check(
+      report[1].attrib_values.byte_count ==
+        eagine::span_size(2 * count * sizeof(float)),
+      "byte count");
+    test.check(report[1].attrib_values.view_byte_count == 0, "no view bytes");
+    test.check(report[1].indices.call_count == 0, "no indices");
+
+    // shared views are counted apart from the copied bytes
+    const auto view{gen->attrib_values_view(
+      vertex_attrib_kind::position, std::type_identity<float>{})};
+    test.ensure(bool(view), "has view");
+    const auto viewed{instr->report()};
+    test.check(viewed[1].attrib_values.call_count == 3, "viewed once");
+    test.check(
+      viewed[1].attrib_values.byte_count == report[1].attrib_values.byte_count,
+      "view not copied");
+    test.check(
+      viewed[1].attrib_values.view_byte_count ==
+        eagine::span_size(count * sizeof(float)),
+      "view byte count");
+
+    std::stringstream json;
+    eagine::shapes::to_json(json, *instr);
+    test.check(
+      json.str().find(R"("name":"torus")") != std::string::npos, "json");
+}
+//------------------------------------------------------------------------------
+auto persisted_values(eagine::shapes::generator& gen)
+  -> std::array<std::vector<float>, 3> {
+    using eagine::shapes::vertex_attrib_kind;
+    std::array<std::vector<float>, 3> result;
+    for(const auto i : eagine::integer_range(2U)) {
+        const auto attrib{
+          i == 0U ? vertex_attrib_kind::position : vertex_attrib_kind::normal};
+        result[i].resize(std::size_t(gen.value_count(attrib)));
+        gen.attrib_values(attrib, eagine::cover(result[i]));
+    }
+    std::vector<std::uint32_t> indices(std::size_t(gen.index_count()));
+    gen.indices(eagine::cover(indices));
+    result[2].assign(indices.begin(), indices.end());
+    return result;
+}
+//------------------------------------------------------------------------------
+void cached_persisted(auto& s) {
+    eagitest::case_ test{s, 7, "persisted"};
+    using eagine::shapes::vertex_attrib_kind;
+
+    const auto directory{
+      std::filesystem::temp_directory_path() /
+      std::format("eagine-shapes-test-{:x}", std::random_device{}())};
+    const auto torus{[] {
+        return eagine::shapes::unit_torus(
+          vertex_attrib_kind::position | vertex_attrib_kind::normal);
+    }};
+    const auto sphere{[] {
+        return eagine::shapes::unit_sphere(
+          vertex_attrib_kind::position | vertex_attrib_kind::normal);
+    }};
+    const auto expected{persisted_values(*torus())};
+
+    const auto stored{eagine::shapes::persistent_cache(
+      torus(), "torus", directory, s.context())};
+    test.ensure(bool(stored), "has generator");
+    test.check(persisted_values(*stored) == expected, "same stored values");
+
+    const auto list_files{[&] {
+        std::vector<std::filesystem::path> result;
+        for(const auto& entry :
+            std::filesystem::directory_iterator{directory}) {
+            result.push_back(entry.path());
+        }
+        return result;
+    }};
+    const auto torus_files{list_files()};
+    test.ensure(torus_files.size() == 1U, "one file");
+
+    // the data are mapped from the file written above
+    const auto loaded{eagine::shapes::persistent_cache(
+      torus(), "torus", directory, s.context())};
+    test.check(persisted_values(*loaded) == expected, "same loaded values");
+    test.check(
+      eagine::span_size(expected[0].size()) ==
+        loaded
+          ->attrib_values_view(
+            vertex_attrib_kind::position, std::type_identity<float>{})
+          .values()
+          .size(),
+      "mapped values");
+
+    // the bounds and ray queries use the mapped data
+    const auto bs{torus()->bounding_sphere()};
+    test.check_equal(
+      loaded->bounding_sphere().radius(), bs.radius(), "stored sphere");
+    const auto bb{torus()->bounding_box()};
+    test.check(loaded->bounding_box().max == bb.max, "stored box");
+    const std::array<eagine::math::line<float>, 1> rays{
+      {{{0.F, 0.F, -2.F}, {0.F, 0.F, 1.F}}}};
+    std::array<eagine::optionally_valid<float>, 1> expected_hits{};
+    std::array<eagine::optionally_valid<float>, 1> loaded_hits{};
+    auto original{torus()};
+    original->ray_intersections(
+      eagine::view(rays), eagine::cover(expected_hits));
+    loaded->ray_intersections(eagine::view(rays), eagine::cover(loaded_hits));
+    test.check(
+      bool(expected_hits[0]) == bool(loaded_hits[0]),
+      "stored ray intersection");
+
+    // the same key with a different shape does not use the stored sections
+    const auto resized{eagine::shapes::persistent_cache(
+      sphere(), "torus", directory, s.context())};
+    test.check(
+      persisted_values(*resized) == persisted_values(*sphere()),
+      "size mismatch fallback");
+
+    // a file with a different key under the name of this one is re-written
+    const auto other{eagine::shapes::persistent_cache(
+      sphere(), "sphere", directory, s.context())};
+    auto files{list_files()};
+    test.ensure(files.size() == 2U, "two files");
+    std::erase(files, torus_files.front());
+    test.ensure(files.size() == 1U, "new file");
+    std::filesystem::copy_file(
+      torus_files.front(),
+      files.front(),
+      std::filesystem::copy_options::overwrite_existing);
+    const auto mismatched{eagine::shapes::persistent_cache(
+      sphere(), "sphere", directory, s.context())};
+    test.check(
+      persisted_values(*mismatched) == persisted_values(*sphere()),
+      "key mismatch fallback");
+
+    // a file with another data version is ignored and re-written
+    {
+        std::fstream file{
+          torus_files.front(),
+          std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(12);
+        const std::uint32_t data_version{0U};
+        file.write(
+          reinterpret_cast<const char*>(&data_version), sizeof(data_version));
+    }
+    const auto versioned{eagine::shapes::persistent_cache(
+      torus(), "torus", directory, s.context())};
+    test.check(persisted_values(*versioned) == expected, "version fallback");
+    const auto reloaded{eagine::shapes::persistent_cache(
+      torus(), "torus", directory, s.context())};
+    test.check(persisted_values(*reloaded) == expected, "re-written version");
+
+    // shapes from URLs with the same arguments in any order share the file
+    const eagine::url locator{"shape:///unit_torus?position=0&normal=0"};
+    test.check(
+      eagine::shapes::shape_key({}, locator) ==
+        eagine::shapes::shape_key(
+          {}, eagine::url{"shape:///unit_torus?normal=0&position=0"}),
+      "same shape key");
+    const auto from_url{eagine::shapes::persistent_shape_from(
+      locator, directory, s.context())};
+    test.ensure(bool(from_url), "has generator from URL");
+    test.check(persisted_values(*from_url) == expected, "same URL values");
+    const auto file_count{list_files().size()};
+    const auto from_other_url{eagine::shapes::persistent_shape_from(
+      eagine::url{"shape:///unit_torus?normal=0&position=0"},
+      directory,
+      s.context())};
+    test.ensure(bool(from_other_url), "has generator from other URL");
+    test.check(list_files().size() == file_count, "shared URL file");
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+}
+//------------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------------
+auto test_main(eagine::test_ctx& ctx) -> int {
+    eagitest::ctx_suite test{ctx, "cached", 7};
+    test.once(cached_same_values);
+    test.once(cached_eviction);
+    test.once(cached_shared_shape);
+    test.once(cached_conversion);
+    test.once(cached_warm_up);
+    test.once(cached_instrumentation);
+    test.once(cached_persisted);
+    return test.exit_code();
+}
+//------------------------------------------------------------------------------
+auto main(int argc, const char** argv) -> int {
+    return eagine::test_main_impl(argc, argv, test_main);
+}
+//------------------------------------------------------------------------------
+#include <eagine/testing/unit_end_ctx.hpp>
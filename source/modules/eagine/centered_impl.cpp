@@ -22,6 +22,8 @@ public:
     void attrib_values(const vertex_attrib_variant, span<float>) override;
 
     auto bounding_sphere() -> math::sphere<float> override;
+
+    auto bounding_box() -> shape_bounding_box override;
 };
 //------------------------------------------------------------------------------
 void centered_gen::attrib_values(
@@ -90,4 +92,16 @@ auto centered_gen::bounding_sphere() -> math::sphere<float> {
     return {{}, bs.radius()};
 }
 //------------------------------------------------------------------------------
+auto centered_gen::bounding_box() -> shape_bounding_box {
+    // the positions are offset by the center of their bounding box
+    const auto bb = delegated_gen::bounding_box();
+    shape_bounding_box result;
+    for(const auto c : integer_range(std_size(3))) {
+        const auto h = (bb.max[c] - bb.min[c]) * 0.5F;
+        result.min[c] = -h;
+        result.max[c] = h;
+    }
+    return result;
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
@@ -75,6 +75,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> final;
 
+    auto bounding_box() -> shape_bounding_box final;
+
     void for_each_triangle(
       generator& gen,
       const drawing_variant var,
@@ -437,10 +439,29 @@ auto combined_gen::bounding_sphere() -> math::sphere<float> {
             radius = math::maximum(
               radius, math::distance(center, bs.direction()) + bs.radius());
         }
+        const auto box_sphere{bounding_box().enclosing_sphere()};
+        if(box_sphere.radius() < radius) {
+            return box_sphere;
+        }
     }
     return {math::point<float, 3>{center}, radius};
 }
 //------------------------------------------------------------------------------
+auto combined_gen::bounding_box() -> shape_bounding_box {
+    if(_gens.empty()) {
+        return {};
+    }
+    auto result{_gens.front()->bounding_box()};
+    for(auto& gen : _gens) {
+        const auto bb{gen->bounding_box()};
+        for(const auto c : integer_range(std_size(3))) {
+            result.min[c] = math::minimum(result.min[c], bb.min[c]);
+            result.max[c] = math::maximum(result.max[c], bb.max[c]);
+        }
+    }
+    return result;
+}
+//------------------------------------------------------------------------------
 void combined_gen::for_each_triangle(
   generator& gen,
   const drawing_variant var,
@@ -55,6 +55,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
 private:
     using _base = generator_base;
 
@@ -541,7 +543,12 @@ void unit_cube_gen::instructions(
 //------------------------------------------------------------------------------
 auto unit_cube_gen::bounding_sphere() -> math::sphere<float> {
     using std::sqrt;
-    return {{}, float(sqrt(2.F))};
+    // the vertices are in the corners of the unit cube
+    return {{}, float(sqrt(3.F)) * 0.5F};
+}
+//------------------------------------------------------------------------------
+auto unit_cube_gen::bounding_box() -> shape_bounding_box {
+    return {{-0.5F, -0.5F, -0.5F}, {0.5F, 0.5F, 0.5F}};
 }
 //------------------------------------------------------------------------------
 } // namespace eagine::shapes
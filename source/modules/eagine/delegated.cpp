@@ -98,6 +98,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
     void for_each_triangle(
       generator& gen,
       const drawing_variant var,
@@ -111,6 +113,10 @@ public:
       const span<const math::line<float>> rays,
       span<optionally_valid<float>> intersections) override;
 
+    void warm_up(
+      const vertex_attrib_kinds attribs,
+      const span<const drawing_variant> vars) override;
+
 protected:
     [[nodiscard]] auto base_generator() const noexcept
       -> shared_holder<generator> {
@@ -284,6 +290,10 @@ inline auto delegated_gen::bounding_sphere() -> math::sphere<float> {
     return _gen->bounding_sphere();
 }
 //------------------------------------------------------------------------------
+inline auto delegated_gen::bounding_box() -> shape_bounding_box {
+    return _gen->bounding_box();
+}
+//------------------------------------------------------------------------------
 inline void delegated_gen::for_each_triangle(
   generator& gen,
   const drawing_variant var,
@@ -304,5 +314,11 @@ inline void delegated_gen::ray_intersections(
     _gen->ray_intersections(gen, var, rays, intersections);
 }
 //------------------------------------------------------------------------------
+inline void delegated_gen::warm_up(
+  const vertex_attrib_kinds attribs,
+  const span<const drawing_variant> vars) {
+    _gen->warm_up(attribs, vars);
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
 
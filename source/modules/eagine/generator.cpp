@@ -100,6 +100,129 @@ export struct random_attribute_values {
 /// @ingroup shapes
 export using drawing_variant = span_size_t;
 //------------------------------------------------------------------------------
+// Returns the attrib_data_type corresponding to the C++ type T.
+template <typename T>
+constexpr auto attrib_data_type_of() noexcept -> attrib_data_type {
+    if constexpr(std::is_same_v<T, byte>) {
+        return attrib_data_type::ubyte;
+    } else if constexpr(std::is_same_v<T, std::int16_t>) {
+        return attrib_data_type::int_16;
+    } else if constexpr(std::is_same_v<T, std::int32_t>) {
+        return attrib_data_type::int_32;
+    } else if constexpr(std::is_same_v<T, std::uint16_t>) {
+        return attrib_data_type::uint_16;
+    } else if constexpr(std::is_same_v<T, std::uint32_t>) {
+        return attrib_data_type::uint_32;
+    } else if constexpr(std::is_same_v<T, float>) {
+        return attrib_data_type::float_;
+    } else {
+        return attrib_data_type::none;
+    }
+}
+//------------------------------------------------------------------------------
+/// @brief Read-only view of shape data, keeping the viewed storage alive.
+/// @ingroup shapes
+/// @see shared_attrib_values
+/// @see shared_indices
+/// @see shared_instructions
+export template <typename T>
+class shared_data_view {
+public:
+    /// @brief Default constructor, constructs an empty view.
+    shared_data_view() noexcept = default;
+
+    /// @brief Construction from the owner of the storage and the viewed data.
+    shared_data_view(
+      std::shared_ptr<const void> owner,
+      const span<const T> values) noexcept
+      : _owner{std::move(owner)}
+      , _values{values} {}
+
+    /// @brief Indicates if the view refers to some storage.
+    explicit operator bool() const noexcept {
+        return bool(_owner);
+    }
+
+    /// @brief Indicates if the viewed data is empty.
+    auto empty() const noexcept -> bool {
+        return _values.empty();
+    }
+
+    /// @brief Returns the number of viewed elements.
+    auto size() const noexcept -> span_size_t {
+        return _values.size();
+    }
+
+    /// @brief Returns the viewed elements as a span.
+    auto values() const noexcept -> span<const T> {
+        return _values;
+    }
+
+    /// @brief Returns the element at the specified index.
+    auto operator[](const std::size_t index) const noexcept -> const T& {
+        return *(_values.data() + index);
+    }
+
+    auto begin() const noexcept {
+        return _values.begin();
+    }
+
+    auto end() const noexcept {
+        return _values.end();
+    }
+
+private:
+    std::shared_ptr<const void> _owner;
+    span<const T> _values;
+};
+//------------------------------------------------------------------------------
+/// @brief Axis-aligned bounding box of a generated shape.
+/// @ingroup shapes
+/// @see generator::bounding_box
+export struct shape_bounding_box {
+    /// @brief The minimal coordinates of the box.
+    std::array<float, 3> min{};
+    /// @brief The maximal coordinates of the box.
+    std::array<float, 3> max{};
+
+    /// @brief Returns the center point of the box.
+    [[nodiscard]] auto center() const noexcept -> math::point<float, 3> {
+        return {
+          (min[0] + max[0]) * 0.5F,
+          (min[1] + max[1]) * 0.5F,
+          (min[2] + max[2]) * 0.5F};
+    }
+
+    /// @brief Returns the smallest sphere enclosing the whole box.
+    [[nodiscard]] auto enclosing_sphere() const noexcept
+      -> math::sphere<float> {
+        float radius{0.F};
+        for(const auto c : integer_range(std_size(3))) {
+            const auto h{(max[c] - min[c]) * 0.5F};
+            radius += h * h;
+        }
+        return {center(), std::sqrt(radius)};
+    }
+
+    /// @brief Indicates if a ray hits the box in front of its origin.
+    [[nodiscard]] auto is_hit_by(const math::line<float>& ray) const noexcept
+      -> bool {
+        const auto orig = ray.origin();
+        const auto dir = ray.direction();
+        const std::array<float, 3> o{orig.x(), orig.y(), orig.z()};
+        const std::array<float, 3> d{dir.x(), dir.y(), dir.z()};
+        float tmin{0.F};
+        float tmax{std::numeric_limits<float>::infinity()};
+        for(const auto c : integer_range(std_size(3))) {
+            const auto t0 = (min[c] - o[c]) / d[c];
+            const auto t1 = (max[c] - o[c]) / d[c];
+            tmin = std::fmax(tmin, std::fmin(t0, t1));
+            tmax = std::fmin(tmax, std::fmax(t0, t1));
+        }
+        return tmin <= tmax;
+    }
+};
+//------------------------------------------------------------------------------
 /// @brief Interface for shape loaders or generators.
 /// @ingroup shapes
 export struct generator : abstract<generator> {
@@ -330,9 +453,105 @@ export struct generator : abstract<generator> {
         return instructions(0, dest);
     }
 
+    /// @brief Returns a view of already stored vertex attribute values, if any.
+    /// @see shared_attrib_values
+    ///
+    /// Generators keeping the attribute values in memory can return a view
+    /// of them and avoid copying. The default implementation returns an
+    /// empty view.
+    [[nodiscard]] virtual auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<byte>) -> shared_data_view<byte> {
+        return {};
+    }
+
+    /// @brief Returns a view of already stored vertex attribute values, if any.
+    /// @see shared_attrib_values
+    [[nodiscard]] virtual auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<std::int16_t>) -> shared_data_view<std::int16_t> {
+        return {};
+    }
+
+    /// @brief Returns a view of already stored vertex attribute values, if any.
+    /// @see shared_attrib_values
+    [[nodiscard]] virtual auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<std::int32_t>) -> shared_data_view<std::int32_t> {
+        return {};
+    }
+
+    /// @brief Returns a view of already stored vertex attribute values, if any.
+    /// @see shared_attrib_values
+    [[nodiscard]] virtual auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<std::uint16_t>) -> shared_data_view<std::uint16_t> {
+        return {};
+    }
+
+    /// @brief Returns a view of already stored vertex attribute values, if any.
+    /// @see shared_attrib_values
+    [[nodiscard]] virtual auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<std::uint32_t>) -> shared_data_view<std::uint32_t> {
+        return {};
+    }
+
+    /// @brief Returns a view of already stored vertex attribute values, if any.
+    /// @see shared_attrib_values
+    [[nodiscard]] virtual auto attrib_values_view(
+      const vertex_attrib_variant,
+      std::type_identity<float>) -> shared_data_view<float> {
+        return {};
+    }
+
+    /// @brief Returns a view of already stored index data, if any.
+    /// @see shared_indices
+    [[nodiscard]] virtual auto indices_view(
+      const drawing_variant,
+      std::type_identity<std::uint8_t>) -> shared_data_view<std::uint8_t> {
+        return {};
+    }
+
+    /// @brief Returns a view of already stored index data, if any.
+    /// @see shared_indices
+    [[nodiscard]] virtual auto indices_view(
+      const drawing_variant,
+      std::type_identity<std::uint16_t>) -> shared_data_view<std::uint16_t> {
+        return {};
+    }
+
+    /// @brief Returns a view of already stored index data, if any.
+    /// @see shared_indices
+    [[nodiscard]] virtual auto indices_view(
+      const drawing_variant,
+      std::type_identity<std::uint32_t>) -> shared_data_view<std::uint32_t> {
+        return {};
+    }
+
+    /// @brief Returns a view of already stored drawing operations, if any.
+    /// @see shared_instructions
+    [[nodiscard]] virtual auto instructions_view(const drawing_variant)
+      -> shared_data_view<draw_operation> {
+        return {};
+    }
+
     /// @brief Returns the bounding sphere for the generated shape.
+    /// @see bounding_box
     virtual auto bounding_sphere() -> math::sphere<float> = 0;
 
+    /// @brief Returns the axis-aligned bounding box for the generated shape.
+    /// @see bounding_sphere
+    ///
+    /// The default implementation returns the box around the bounding sphere.
+    virtual auto bounding_box() -> shape_bounding_box {
+        const auto bs{bounding_sphere()};
+        const auto c{bs.center()};
+        const auto r{bs.radius()};
+        return {
+          {c.x() - r, c.y() - r, c.z() - r}, {c.x() + r, c.y() + r, c.z() + r}};
+    }
+
     /// @brief Calls a callback for each triangle in specified drawing variant.
     virtual void for_each_triangle(
       generator& gen,
@@ -391,8 +610,79 @@ export struct generator : abstract<generator> {
         ray_intersections(*this, 0, view_one(ray), cover_one(result));
         return result;
     }
+
+    /// @brief Prepares the data of the specified attributes and draw variants.
+    /// @see cache_options
+    ///
+    /// Generators keeping their data in memory can use this to populate
+    /// them eagerly, possibly in parallel. The default implementation
+    /// does nothing.
+    virtual void warm_up(
+      const vertex_attrib_kinds,
+      const span<const drawing_variant>) {}
+
+    /// @brief Prepares the data of all attributes and draw variants.
+    void warm_up() {
+        std::vector<drawing_variant> vars;
+        for(const auto index : integer_range(draw_variant_count())) {
+            vars.push_back(draw_variant(index));
+        }
+        warm_up(attrib_kinds(), view(vars));
+    }
 };
 //------------------------------------------------------------------------------
+/// @brief Returns the vertex attribute values of gen without copying if possible.
+/// @ingroup shapes
+/// @see generator::attrib_values_view
+///
+/// If the generator does not store the values, they are fetched into
+/// a newly allocated buffer owned by the returned view.
+export template <typename T>
+[[nodiscard]] auto shared_attrib_values(
+  generator& gen,
+  const vertex_attrib_variant vav) -> shared_data_view<T> {
+    if(auto stored{gen.attrib_values_view(vav, std::type_identity<T>{})}) {
+        return stored;
+    }
+    auto values{
+      std::make_shared<std::vector<T>>(std_size(gen.value_count(vav)))};
+    gen.attrib_values(vav, cover(*values));
+    const span<const T> values_view{view(*values)};
+    return {std::move(values), values_view};
+}
+//------------------------------------------------------------------------------
+/// @brief Returns the index data of gen without copying if possible.
+/// @ingroup shapes
+/// @see generator::indices_view
+export template <typename T>
+[[nodiscard]] auto shared_indices(generator& gen, const drawing_variant var)
+  -> shared_data_view<T> {
+    if(auto stored{gen.indices_view(var, std::type_identity<T>{})}) {
+        return stored;
+    }
+    auto values{
+      std::make_shared<std::vector<T>>(std_size(gen.index_count(var)))};
+    gen.indices(var, cover(*values));
+    const span<const T> values_view{view(*values)};
+    return {std::move(values), values_view};
+}
+//------------------------------------------------------------------------------
+/// @brief Returns the drawing operations of gen without copying if possible.
+/// @ingroup shapes
+/// @see generator::instructions_view
+export [[nodiscard]] auto shared_instructions(
+  generator& gen,
+  const drawing_variant var) -> shared_data_view<draw_operation> {
+    if(auto stored{gen.instructions_view(var)}) {
+        return stored;
+    }
+    auto values{std::make_shared<std::vector<draw_operation>>(
+      std_size(gen.operation_count(var)))};
+    gen.instructions(var, cover(*values));
+    const span<const draw_operation> values_view{view(*values)};
+    return {std::move(values), values_view};
+}
+//------------------------------------------------------------------------------
 /// @brief Common base implementation of the shape generator interface.
 /// @ingroup shapes
 class generator_base : public generator {
@@ -454,6 +744,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
     void for_each_triangle(
       generator& gen,
       const drawing_variant var,
@@ -473,9 +765,16 @@ protected:
       const generator_capabilities supported_caps) noexcept;
 
 private:
+    auto _scan_bounding_sphere() -> math::sphere<float>;
+    auto _scan_bounding_box() -> shape_bounding_box;
+
     vertex_attrib_kinds _attr_kinds;
     const generator_capabilities _supported_caps;
     generator_capabilities _enabled_caps{_supported_caps};
+    std::once_flag _bounding_sphere_once;
+    math::sphere<float> _bounding_sphere;
+    std::once_flag _bounding_box_once;
+    shape_bounding_box _bounding_box;
 };
 //------------------------------------------------------------------------------
 export auto operator+(
@@ -954,11 +1253,193 @@ export template <std::size_t N>
 //------------------------------------------------------------------------------
 // cached
 //------------------------------------------------------------------------------
+export class generator_instrumentation;
+
+/// @brief Options of the cached_gen modifier.
+/// @ingroup shapes
+/// @see cache
+export struct cache_options {
+    /// @brief Maximum number of bytes held in cached data buffers.
+    /// @note Zero means unbounded. Least recently used buffers are evicted.
+    span_size_t max_bytes{0};
+    /// @brief Indicates if all data should be cached in parallel right away.
+    /// @see generator::warm_up
+    bool warm_up{false};
+    /// @brief Optional instrumentation recording the fetches and ray queries.
+    /// @note The calls are recorded under the "cache" node.
+    std::shared_ptr<generator_instrumentation> instrumentation{};
+};
+
+/// @brief Usage statistics of the cached_gen modifier.
+/// @ingroup shapes
+/// @see cache_statistics_of
+export struct cache_statistics {
+    /// @brief The number of data requests served from the cache.
+    span_size_t hits{0};
+    /// @brief The number of data requests fetched from the cached generator.
+    span_size_t misses{0};
+    /// @brief The number of data buffers evicted to stay within the budget.
+    span_size_t evictions{0};
+    /// @brief The number of bytes currently held in the cached data buffers.
+    /// @note Includes the ray intersection hierarchies, which are not evicted.
+    span_size_t bytes_resident{0};
+};
+
 /// @brief Constructs instances of cached_gen modifier.
 /// @ingroup shapes
 export [[nodiscard]] auto cache(
   shared_holder<generator> gen,
   main_ctx_parent parent) noexcept -> shared_holder<generator>;
+
+/// @brief Constructs instances of cached_gen modifier with the specified options.
+/// @ingroup shapes
+export [[nodiscard]] auto cache(
+  shared_holder<generator> gen,
+  const cache_options& opts,
+  main_ctx_parent parent) noexcept -> shared_holder<generator>;
+
+/// @brief Returns the usage statistics if gen is a cached_gen modifier.
+/// @ingroup shapes
+/// @see cache
+export auto cache_statistics_of(generator& gen) noexcept
+  -> std::optional<cache_statistics>;
+//------------------------------------------------------------------------------
+// persisted
+//------------------------------------------------------------------------------
+/// @brief Constructs a cache of gen persisted in a file in the specified directory.
+/// @ingroup shapes
+/// @see cache
+///
+/// The key must uniquely describe the shape and all parameters affecting its
+/// data, the file name is derived from a hash of the key. If the file exists
+/// the data are memory-mapped and served without re-generating the shape,
+/// otherwise the data are fetched from gen and written into the file first.
+/// If the file cannot be read or written the in-memory cache is used, but
+/// exceptions thrown by gen while fetching the data are propagated.
+export [[nodiscard]] auto persistent_cache(
+  shared_holder<generator> gen,
+  const string_view key,
+  const std::filesystem::path& directory,
+  main_ctx_parent parent) -> shared_holder<generator>;
+//------------------------------------------------------------------------------
+// instrumented
+//------------------------------------------------------------------------------
+/// @brief Statistics of one kind of calls to an instrumented generator.
+/// @ingroup shapes
+/// @see generator_node_statistics
+export struct generator_call_statistics {
+    /// @brief The number of calls.
+    span_size_t call_count{0};
+    /// @brief The number of bytes of data copied by the calls.
+    span_size_t byte_count{0};
+    /// @brief The number of bytes of data shared without copying by the calls.
+    /// @note These bytes are not included in byte_count.
+    span_size_t view_byte_count{0};
+    /// @brief The number of rays traced by ray intersection calls.
+    span_size_t ray_count{0};
+    /// @brief The wall time spent in the calls.
+    std::chrono::nanoseconds duration{};
+};
+
+/// @brief Statistics of calls to a single instrumented generator.
+/// @ingroup shapes
+/// @see generator_instrumentation
+export struct generator_node_statistics {
+    /// @brief The name of the instrumented generator.
+    std::string name;
+    /// @brief Statistics of the calls getting attribute values.
+    generator_call_statistics attrib_values;
+    /// @brief Statistics of the calls getting indices.
+    generator_call_statistics indices;
+    /// @brief Statistics of the calls getting drawing instructions.
+    generator_call_statistics instructions;
+    /// @brief Statistics of the ray intersection calls.
+    generator_call_statistics ray_intersections;
+};
+
+/// @brief Collects the call statistics of a set of instrumented generators.
+/// @ingroup shapes
+/// @see instrument
+///
+/// A single instance is typically shared by all instrumented nodes of a shape
+/// generator pipeline. The counters can be updated concurrently.
+export class generator_instrumentation {
+public:
+    /// @brief Counters of one kind of calls to an instrumented generator.
+    struct call_counters {
+        std::atomic<std::uint64_t> calls{0U};
+        std::atomic<std::uint64_t> bytes{0U};
+        std::atomic<std::uint64_t> view_bytes{0U};
+        std::atomic<std::uint64_t> rays{0U};
+        std::atomic<std::uint64_t> nanoseconds{0U};
+
+        void add(
+          const span_size_t byte_count,
+          const std::chrono::nanoseconds duration) noexcept {
+            calls.fetch_add(1U, std::memory_order_relaxed);
+            bytes.fetch_add(
+              std::uint64_t(byte_count), std::memory_order_relaxed);
+            nanoseconds.fetch_add(
+              std::uint64_t(duration.count()), std::memory_order_relaxed);
+        }
+
+        void add_view(
+          const span_size_t byte_count,
+          const std::chrono::nanoseconds duration) noexcept {
+            calls.fetch_add(1U, std::memory_order_relaxed);
+            view_bytes.fetch_add(
+              std::uint64_t(byte_count), std::memory_order_relaxed);
+            nanoseconds.fetch_add(
+              std::uint64_t(duration.count()), std::memory_order_relaxed);
+        }
+
+        void add_rays(
+          const span_size_t ray_count,
+          const std::chrono::nanoseconds duration) noexcept {
+            add(
+              ray_count * span_size(sizeof(optionally_valid<float>)),
+              duration);
+            rays.fetch_add(std::uint64_t(ray_count), std::memory_order_relaxed);
+        }
+
+        auto statistics() const noexcept -> generator_call_statistics;
+    };
+
+    /// @brief Counters of all calls to an instrumented generator.
+    struct node_counters {
+        node_counters(std::string n) noexcept
+          : name{std::move(n)} {}
+
+        const std::string name;
+        call_counters attrib_values;
+        call_counters indices;
+        call_counters instructions;
+        call_counters ray_intersections;
+    };
+
+    /// @brief Adds the counters for a new instrumented generator.
+    auto add_node(const string_view name) -> node_counters&;
+
+    /// @brief Returns the statistics of all nodes, in the order of addition.
+    [[nodiscard]] auto report() const -> std::vector<generator_node_statistics>;
+
+private:
+    mutable std::mutex _mutex;
+    std::deque<node_counters> _nodes;
+};
+
+/// @brief Constructs instances of instrumented_gen modifier.
+/// @ingroup shapes
+/// @see generator_instrumentation
+///
+/// The returned generator measures the calls producing data of gen and records
+/// them under the specified name into instr. Instrumenting several nodes of
+/// a pipeline shows where the time is spent when the shape is materialized.
+export [[nodiscard]] auto instrument(
+  shared_holder<generator> gen,
+  const string_view name,
+  std::shared_ptr<generator_instrumentation> instr) noexcept
+  -> shared_holder<generator>;
 //------------------------------------------------------------------------------
 // array
 //------------------------------------------------------------------------------
@@ -1075,6 +1556,29 @@ export [[nodiscard]] auto surface_points(
   const vertex_attrib_variant weight_variant,
   main_ctx_parent parent) noexcept -> shared_holder<generator>;
 //------------------------------------------------------------------------------
+/// @brief Constructs instance of surface_points_gen modifier.
+/// @ingroup shapes
+/// @see topology
+///
+/// The shape topology is persisted in and reused from the specified directory.
+export [[nodiscard]] auto surface_points(
+  shared_holder<generator> gen,
+  const span_size_t point_count,
+  const std::filesystem::path& topology_dir,
+  main_ctx_parent parent) noexcept -> shared_holder<generator>;
+//------------------------------------------------------------------------------
+/// @brief Constructs instance of surface_points_gen modifier.
+/// @ingroup shapes
+/// @see topology
+///
+/// The shape topology is persisted in and reused from the specified directory.
+export [[nodiscard]] auto surface_points(
+  shared_holder<generator> gen,
+  const span_size_t point_count,
+  const vertex_attrib_variant weight_variant,
+  const std::filesystem::path& topology_dir,
+  main_ctx_parent parent) noexcept -> shared_holder<generator>;
+//------------------------------------------------------------------------------
 // add_triangle_adjacency
 //------------------------------------------------------------------------------
 /// @brief Constructs instances of triangle_adjacency_gen modifier.
@@ -1083,6 +1587,17 @@ export [[nodiscard]] auto add_triangle_adjacency(
   shared_holder<generator> gen,
   const drawing_variant var,
   main_ctx_parent parent) noexcept -> shared_holder<generator>;
+
+/// @brief Constructs instances of triangle_adjacency_gen modifier.
+/// @ingroup shapes
+/// @see topology
+///
+/// The shape topology is persisted in and reused from the specified directory.
+export [[nodiscard]] auto add_triangle_adjacency(
+  shared_holder<generator> gen,
+  const drawing_variant var,
+  const std::filesystem::path& topology_dir,
+  main_ctx_parent parent) noexcept -> shared_holder<generator>;
 //------------------------------------------------------------------------------
 /// @brief Constructs instances of triangle_adjacency_gen modifier.
 /// @ingroup shapes
@@ -54,48 +54,127 @@ void generator_base::attrib_values(
 }
 //------------------------------------------------------------------------------
 auto generator_base::bounding_sphere() -> math::sphere<float> {
-    std::array<float, 3> min{
-      std::numeric_limits<float>::max(),
-      std::numeric_limits<float>::max(),
-      std::numeric_limits<float>::max()};
-
-    std::array<float, 3> max{
-      std::numeric_limits<float>::lowest(),
-      std::numeric_limits<float>::lowest(),
-      std::numeric_limits<float>::lowest()};
+    // the positions are scanned only once, on the first request
+    std::call_once(_bounding_sphere_once, [this] {
+        _bounding_sphere = _scan_bounding_sphere();
+    });
+    return _bounding_sphere;
+}
+//------------------------------------------------------------------------------
+auto generator_base::bounding_box() -> shape_bounding_box {
+    std::call_once(
+      _bounding_box_once, [this] { _bounding_box = _scan_bounding_box(); });
+    return _bounding_box;
+}
+//------------------------------------------------------------------------------
+auto generator_base::_scan_bounding_box() -> shape_bounding_box {
+    shape_bounding_box result{
+      {std::numeric_limits<float>::max(),
+       std::numeric_limits<float>::max(),
+       std::numeric_limits<float>::max()},
+      {std::numeric_limits<float>::lowest(),
+       std::numeric_limits<float>::lowest(),
+       std::numeric_limits<float>::lowest()}};
 
     const auto attrib = vertex_attrib_kind::position;
     const auto n = vertex_count();
-    const auto m = values_per_vertex(attrib);
+    const auto m = math::minimum(values_per_vertex(attrib), span_size_t(3));
+
+    if(n <= 0) {
+        return {};
+    }
 
-    std::vector<float> temp;
-    temp.resize(integer(n * m));
-    auto pos = cover(temp);
-    attrib_values(attrib, pos);
+    const auto pos{shared_attrib_values<float>(*this, attrib)};
+    const auto vpv = values_per_vertex(attrib);
 
     for(const auto v : integer_range(n)) {
         for(const auto c : integer_range(m)) {
             const integer k{c};
 
-            min[k] = eagine::math::minimum(min[k], pos[v * m + c]);
-            max[k] = eagine::math::maximum(max[k], pos[v * m + c]);
+            result.min[k] =
+              eagine::math::minimum(result.min[k], pos[v * vpv + c]);
+            result.max[k] =
+              eagine::math::maximum(result.max[k], pos[v * vpv + c]);
         }
     }
+    for(const auto c : integer_range(m, span_size_t(3))) {
+        result.min[std_size(c)] = result.max[std_size(c)] = 0.F;
+    }
+    return result;
+}
+//------------------------------------------------------------------------------
+auto generator_base::_scan_bounding_sphere() -> math::sphere<float> {
+    // The sphere enclosing the bounding box is only a good bound
+    // for box-like shapes, Ritter's algorithm gives a sphere that is
+    // usually within a few percent of the minimal one. The smaller
+    // of the two is used.
+    const auto box_sphere{bounding_box().enclosing_sphere()};
+
+    const auto attrib = vertex_attrib_kind::position;
+    const auto n = vertex_count();
+    const auto m = math::minimum(values_per_vertex(attrib), span_size_t(3));
+    const auto vpv = values_per_vertex(attrib);
+
+    if(n <= 0) {
+        return box_sphere;
+    }
 
-    math::point<float, 3> center{
-      (min[0] + max[0]) * 0.5F,
-      (min[1] + max[1]) * 0.5F,
-      (min[2] + max[2]) * 0.5F};
+    const auto pos{shared_attrib_values<float>(*this, attrib)};
 
-    float radius{0.F};
-    for(const auto c : integer_range(m)) {
-        const integer k{c};
-        radius = math::maximum(radius, std::abs(center[k] - max[k]));
-        radius = math::maximum(radius, std::abs(center[k] - min[k]));
+    const auto point_at{[&](span_size_t v) {
+        std::array<double, 3> result{0.0, 0.0, 0.0};
+        for(const auto c : integer_range(m)) {
+            result[std_size(c)] = pos[v * vpv + c];
+        }
+        return result;
+    }};
+    const auto dist{[](const auto& a, const auto& b) {
+        return std::sqrt(
+          (a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) +
+          (a[2] - b[2]) * (a[2] - b[2]));
+    }};
+    const auto farthest_from{[&](const std::array<double, 3>& p) {
+        span_size_t result{0};
+        double max_dist{0.0};
+        for(const auto v : integer_range(n)) {
+            const auto d{dist(p, point_at(v))};
+            if(max_dist < d) {
+                max_dist = d;
+                result = v;
+            }
+        }
+        return point_at(result);
+    }};
+
+    const auto y{farthest_from(point_at(0))};
+    const auto z{farthest_from(y)};
+
+    std::array<double, 3> center{
+      (y[0] + z[0]) * 0.5, (y[1] + z[1]) * 0.5, (y[2] + z[2]) * 0.5};
+    double radius{dist(y, z) * 0.5};
+
+    for(const auto v : integer_range(n)) {
+        const auto p{point_at(v)};
+        const auto d{dist(center, p)};
+        if(d > radius) {
+            const auto new_radius{(radius + d) * 0.5};
+            const auto shift{(d - new_radius) / d};
+            for(const auto c : integer_range(std_size(3))) {
+                center[c] += (p[c] - center[c]) * shift;
+            }
+            radius = new_radius;
+        }
     }
-    radius = std::sqrt(3 * radius * radius);
+    // compensate for the rounding of the float results
+    radius *= 1.0 + 1.0e-5;
 
-    return {center, radius};
+    if(box_sphere.radius() <= float(radius)) {
+        return box_sphere;
+    }
+    return {
+      math::point<float, 3>{
+        float(center[0]), float(center[1]), float(center[2])},
+      float(radius)};
 }
 //------------------------------------------------------------------------------
 void generator_base::for_each_triangle(
@@ -103,17 +182,12 @@ void generator_base::for_each_triangle(
   const drawing_variant var,
   const callable_ref<void(const shape_face_info&)> callback) {
 
-    std::vector<draw_operation> ops;
-    ops.resize(integer(gen.operation_count(var)));
-    gen.instructions(var, cover(ops));
-
-    std::vector<std::uint32_t> idx;
-    idx.resize(integer(gen.index_count(var)));
-    gen.indices(var, cover(idx));
+    const auto ops{shared_instructions(gen, var)};
+    const auto idx{shared_indices<std::uint32_t>(gen, var)};
 
     const auto get_index{[&idx](auto vx, bool idxd) -> span_size_t {
         if(idxd) {
-            return integer(idx[integer(vx)]);
+            return integer(idx[std_size(vx)]);
         } else {
             return integer(vx);
         }
@@ -164,18 +238,17 @@ void generator_base::ray_intersections(
     const auto pvak = vertex_attrib_kind::position;
     const auto vpv = gen.values_per_vertex(pvak);
 
-    std::vector<float> pos;
-    pos.resize(integer(gen.vertex_count() * vpv));
-    gen.attrib_values(pvak, cover(pos));
+    const auto pos{shared_attrib_values<float>(gen, pvak)};
 
     std::vector<std::size_t> ray_idx;
 
     const auto bs = gen.bounding_sphere();
+    const auto bb = gen.bounding_box();
 
     for(const auto i : index_range(rays)) {
         const auto nparam = math::nearest_ray_param(
           math::line_sphere_intersection_params(rays[i], bs));
-        if(nparam >= 0.F) {
+        if(nparam >= 0.F and bb.is_hit_by(rays[i])) {
             ray_idx.push_back(std_size(i));
         }
     }
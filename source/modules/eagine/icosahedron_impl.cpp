@@ -47,6 +47,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
 private:
     using _base = generator_base;
 
@@ -328,5 +330,12 @@ auto unit_icosahedron_gen::bounding_sphere() -> math::sphere<float> {
     return {{}, 1.F};
 }
 //------------------------------------------------------------------------------
+auto unit_icosahedron_gen::bounding_box() -> shape_bounding_box {
+    // see positions, the largest coordinate of the vertices
+    const auto il = 1.0 / std::sqrt(1.0 + std::pow(math::phi, 2.0));
+    const auto c = float(math::phi * il * 0.5);
+    return {{-c, -c, -c}, {c, c, c}};
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
 
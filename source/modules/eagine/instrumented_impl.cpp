@@ -0,0 +1,276 @@
+/// @file
+///
+/// Copyright Matus Chochlik.
+/// Distributed under the Boost Software License, Version 1.0.
+/// See accompanying file LICENSE_1_0.txt or copy at
+/// https://www.boost.org/LICENSE_1_0.txt
+///
+module eagine.shapes;
+
+import std;
+import eagine.core;
+
+namespace eagine::shapes {
+//------------------------------------------------------------------------------
+// generator_instrumentation
+//------------------------------------------------------------------------------
+auto generator_instrumentation::call_counters::statistics() const noexcept
+  -> generator_call_statistics {
+    generator_call_statistics result;
+    result.call_count = limit_cast<span_size_t>(
+      calls.load(std::memory_order_relaxed));
+    result.byte_count = limit_cast<span_size_t>(
+      bytes.load(std::memory_order_relaxed));
+    result.view_byte_count = limit_cast<span_size_t>(
+      view_bytes.load(std::memory_order_relaxed));
+    result.ray_count = limit_cast<span_size_t>(
+      rays.load(std::memory_order_relaxed));
+    result.duration = std::chrono::nanoseconds{
+      limit_cast<std::int64_t>(nanoseconds.load(std::memory_order_relaxed))};
+    return result;
+}
+//------------------------------------------------------------------------------
+auto generator_instrumentation::add_node(const string_view name)
+  -> node_counters& {
+    const std::unique_lock lock{_mutex};
+    // the deque does not relocate the existing nodes
+    return _nodes.emplace_back(to_string(name));
+}
+//------------------------------------------------------------------------------
+auto generator_instrumentation::report() const
+  -> std::vector<generator_node_statistics> {
+    const std::unique_lock lock{_mutex};
+    std::vector<generator_node_statistics> result;
+    result.reserve(_nodes.size());
+    for(const auto& node : _nodes) {
+        auto& stats = result.emplace_back();
+        stats.name = node.name;
+        stats.attrib_values = node.attrib_values.statistics();
+        stats.indices = node.indices.statistics();
+        stats.instructions = node.instructions.statistics();
+        stats.ray_intersections = node.ray_intersections.statistics();
+    }
+    return result;
+}
+//------------------------------------------------------------------------------
+// instrumented_gen
+//------------------------------------------------------------------------------
+class instrumented_gen : public delegated_gen {
+    using _counters = generator_instrumentation::call_counters;
+
+public:
+    instrumented_gen(
+      shared_holder<generator> gen,
+      const string_view name,
+      std::shared_ptr<generator_instrumentation> instr) noexcept
+      : delegated_gen{std::move(gen)}
+      , _instr{std::move(instr)}
+      , _node{_instr->add_node(name)} {}
+
+    void attrib_values(const vertex_attrib_variant vav, span<byte> dest) final {
+        _measure_values(vav, dest);
+    }
+
+    void attrib_values(const vertex_attrib_variant vav, span<std::int16_t> dest)
+      final {
+        _measure_values(vav, dest);
+    }
+
+    void attrib_values(const vertex_attrib_variant vav, span<std::int32_t> dest)
+      final {
+        _measure_values(vav, dest);
+    }
+
+    void attrib_values(
+      const vertex_attrib_variant vav,
+      span<std::uint16_t> dest) final {
+        _measure_values(vav, dest);
+    }
+
+    void attrib_values(
+      const vertex_attrib_variant vav,
+      span<std::uint32_t> dest) final {
+        _measure_values(vav, dest);
+    }
+
+    void attrib_values(const vertex_attrib_variant vav, span<float> dest)
+      final {
+        _measure_values(vav, dest);
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<byte> tid) -> shared_data_view<byte> final {
+        return _measure_view(_node.attrib_values, [&] {
+            return base_generator()->attrib_values_view(vav, tid);
+        });
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::int16_t> tid)
+      -> shared_data_view<std::int16_t> final {
+        return _measure_view(_node.attrib_values, [&] {
+            return base_generator()->attrib_values_view(vav, tid);
+        });
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::int32_t> tid)
+      -> shared_data_view<std::int32_t> final {
+        return _measure_view(_node.attrib_values, [&] {
+            return base_generator()->attrib_values_view(vav, tid);
+        });
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::uint16_t> tid)
+      -> shared_data_view<std::uint16_t> final {
+        return _measure_view(_node.attrib_values, [&] {
+            return base_generator()->attrib_values_view(vav, tid);
+        });
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::uint32_t> tid)
+      -> shared_data_view<std::uint32_t> final {
+        return _measure_view(_node.attrib_values, [&] {
+            return base_generator()->attrib_values_view(vav, tid);
+        });
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<float> tid) -> shared_data_view<float> final {
+        return _measure_view(_node.attrib_values, [&] {
+            return base_generator()->attrib_values_view(vav, tid);
+        });
+    }
+
+    void indices(const drawing_variant var, span<std::uint8_t> dest) final {
+        _measure_indices(var, dest);
+    }
+
+    void indices(const drawing_variant var, span<std::uint16_t> dest) final {
+        _measure_indices(var, dest);
+    }
+
+    void indices(const drawing_variant var, span<std::uint32_t> dest) final {
+        _measure_indices(var, dest);
+    }
+
+    auto indices_view(
+      const drawing_variant var,
+      std::type_identity<std::uint8_t> tid)
+      -> shared_data_view<std::uint8_t> final {
+        return _measure_view(_node.indices, [&] {
+            return base_generator()->indices_view(var, tid);
+        });
+    }
+
+    auto indices_view(
+      const drawing_variant var,
+      std::type_identity<std::uint16_t> tid)
+      -> shared_data_view<std::uint16_t> final {
+        return _measure_view(_node.indices, [&] {
+            return base_generator()->indices_view(var, tid);
+        });
+    }
+
+    auto indices_view(
+      const drawing_variant var,
+      std::type_identity<std::uint32_t> tid)
+      -> shared_data_view<std::uint32_t> final {
+        return _measure_view(_node.indices, [&] {
+            return base_generator()->indices_view(var, tid);
+        });
+    }
+
+    void instructions(const drawing_variant var, span<draw_operation> dest)
+      final {
+        _measure(_node.instructions, dest, [&] {
+            delegated_gen::instructions(var, dest);
+        });
+    }
+
+    auto instructions_view(const drawing_variant var)
+      -> shared_data_view<draw_operation> final {
+        return _measure_view(_node.instructions, [&] {
+            return base_generator()->instructions_view(var);
+        });
+    }
+
+    void ray_intersections(
+      generator& gen,
+      const drawing_variant var,
+      const span<const math::line<float>> rays,
+      span<optionally_valid<float>> intersections) final {
+        const auto start{std::chrono::steady_clock::now()};
+        // the wrapped generator may use its own acceleration structures
+        auto& base = *base_generator();
+        base.ray_intersections(
+          &gen == this ? base : gen, var, rays, intersections);
+        _node.ray_intersections.add_rays(
+          rays.size(),
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start));
+    }
+
+private:
+    template <typename T, typename Func>
+    static void _measure(_counters& counters, span<T> dest, Func func) {
+        const auto start{std::chrono::steady_clock::now()};
+        func();
+        counters.add(
+          dest.size() * span_size(sizeof(T)),
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start));
+    }
+
+    template <typename Func>
+    static auto _measure_view(_counters& counters, Func func) {
+        const auto start{std::chrono::steady_clock::now()};
+        auto result{func()};
+        // views that are not available are served by a copy, measured then
+        // the shared bytes are not copied, so they are counted separately
+        if(result) {
+            counters.add_view(
+              result.size() * span_size(sizeof(*result.begin())),
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start));
+        }
+        return result;
+    }
+
+    template <typename T>
+    void _measure_values(const vertex_attrib_variant vav, span<T> dest) {
+        _measure(_node.attrib_values, dest, [&] {
+            delegated_gen::attrib_values(vav, dest);
+        });
+    }
+
+    template <typename T>
+    void _measure_indices(const drawing_variant var, span<T> dest) {
+        _measure(
+          _node.indices, dest, [&] { delegated_gen::indices(var, dest); });
+    }
+
+    std::shared_ptr<generator_instrumentation> _instr;
+    generator_instrumentation::node_counters& _node;
+};
+//------------------------------------------------------------------------------
+auto instrument(
+  shared_holder<generator> gen,
+  const string_view name,
+  std::shared_ptr<generator_instrumentation> instr) noexcept
+  -> shared_holder<generator> {
+    if(gen and instr) {
+        return {hold<instrumented_gen>, std::move(gen), name, std::move(instr)};
+    }
+    return std::move(gen);
+}
+//------------------------------------------------------------------------------
+} // namespace eagine::shapes
@@ -23,148 +23,644 @@ class occluded_gen
 public:
     occluded_gen(
       shared_holder<generator> gen,
-      const span_size_t samples,
+      const occlusion_options& opts,
       main_ctx_parent parent) noexcept;
 
     void occlusions(const vertex_attrib_variant, span<float>);
+    void bent_normals(span<float>);
+
+    auto attribute_variants(const vertex_attrib_kind) -> span_size_t override;
+    auto variant_name(const vertex_attrib_variant) -> string_view override;
+    auto find_variant(const vertex_attrib_kind, const string_view)
+      -> vertex_attrib_variant override;
+    auto attrib_type(const vertex_attrib_variant) -> attrib_data_type override;
+
     void attrib_values(const vertex_attrib_variant, span<float>) override;
 
 private:
-    span_size_t _samples{64};
+    auto _bent_normal_variant() -> vertex_attrib_variant;
+    auto _is_bent_normal(const vertex_attrib_variant) -> bool;
+    void _trace();
+
+    occlusion_options _options;
+    generator_instrumentation::node_counters* const _instr_node;
+
+    std::mutex _mutex;
+    bool _traced{false};
+    std::vector<float> _occlusions;
+    std::vector<float> _bent_normals;
 };
 //------------------------------------------------------------------------------
+auto occlude(
+  shared_holder<generator> gen,
+  const occlusion_options& opts,
+  main_ctx_parent parent) noexcept -> shared_holder<generator> {
+    return {hold<occluded_gen>, std::move(gen), opts, parent};
+}
+//------------------------------------------------------------------------------
 auto occlude(
   shared_holder<generator> gen,
   const span_size_t samples,
   main_ctx_parent parent) noexcept -> shared_holder<generator> {
-    return {hold<occluded_gen>, std::move(gen), samples, parent};
+    return occlude(std::move(gen), occlusion_options{samples}, parent);
+}
+//------------------------------------------------------------------------------
+auto parse_from(main_ctx& ctx, occlusion_options& opts) noexcept -> bool {
+    for(const auto arg : ctx.args()) {
+        if(arg.is_long_tag("shape-occlusion-samples")) {
+            if(not assign_if_fits(arg.next(), opts.samples) or
+               opts.samples <= 0) {
+                ctx.log()
+                  .error("invalid occlusion sample count")
+                  .arg("value", arg.next().get());
+                return false;
+            }
+        } else if(arg.is_long_tag("shape-occlusion-sampling")) {
+            bool found{false};
+            for(const auto& info : enumerators<occlusion_sampling>()) {
+                if(are_equal(arg.next().get(), info.name)) {
+                    opts.sampling = info.enumerator;
+                    found = true;
+                }
+            }
+            if(not found) {
+                ctx.log()
+                  .error("invalid occlusion sampling strategy")
+                  .arg("value", arg.next().get());
+                return false;
+            }
+        } else if(arg.is_long_tag("shape-occlusion-cosine-weighted")) {
+            opts.cosine_weighted = true;
+        } else if(arg.is_long_tag("shape-occlusion-bent-normals")) {
+            opts.bent_normals = true;
+        } else if(arg.is_long_tag("shape-occlusion-serial")) {
+            opts.parallel = false;
+        } else if(arg.is_long_tag("shape-occlusion-seed")) {
+            std::uint64_t seed{0U};
+            if(not assign_if_fits(arg.next(), seed)) {
+                ctx.log()
+                  .error("invalid occlusion seed")
+                  .arg("value", arg.next().get());
+                return false;
+            }
+            opts.seed = seed;
+        } else if(arg.is_long_tag("shape-occlusion-vertex-range")) {
+            const auto range{arg.next().get()};
+            const auto sep{range.find(':')};
+            span_size_t first{0};
+            span_size_t count{0};
+            const auto parse{[](string_view str, span_size_t& value) {
+                const auto [end, err] =
+                  std::from_chars(str.data(), str.data() + str.size(), value);
+                return (err == std::errc{}) and
+                       (end == str.data() + str.size()) and (value >= 0);
+            }};
+            if(
+              (sep == string_view::npos) or
+              not parse(range.substr(0, sep), first) or
+              not parse(range.substr(sep + 1), count)) {
+                ctx.log()
+                  .error("invalid occlusion vertex range")
+                  .arg("value", range);
+                return false;
+            }
+            opts.first_vertex = first;
+            opts.vertex_count = count;
+        } else if(arg.is_long_tag("shape-occlusion-tolerance")) {
+            if(not assign_if_fits(arg.next(), opts.tolerance) or
+               opts.tolerance < 0.F) {
+                ctx.log()
+                  .error("invalid occlusion tolerance")
+                  .arg("value", arg.next().get());
+                return false;
+            }
+        } else if(arg.is_long_tag("shape-occlusion-batch")) {
+            if(not assign_if_fits(arg.next(), opts.batch_size) or
+               opts.batch_size <= 0) {
+                ctx.log()
+                  .error("invalid occlusion batch size")
+                  .arg("value", arg.next().get());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+//------------------------------------------------------------------------------
+auto persistent_cache_key(const occlusion_options& opts) -> std::string {
+    std::string key{std::format(
+      "occlusion?samples={}&sampling={}&cosine={}&tolerance={}&batch={}"
+      "&bent={}&first={}",
+      opts.samples,
+      enumerator_name(opts.sampling).std_view(),
+      opts.cosine_weighted,
+      opts.tolerance,
+      opts.batch_size,
+      opts.bent_normals,
+      opts.first_vertex)};
+    if(opts.vertex_count) {
+        key.append(std::format("&count={}", *opts.vertex_count));
+    }
+    if(opts.seed) {
+        key.append(std::format("&seed={}", *opts.seed));
+    }
+    return key;
+}
+//------------------------------------------------------------------------------
+static auto occlusion_radical_inverse(
+  const std::uint32_t base,
+  std::uint32_t i) noexcept -> float {
+    const float inv_base{1.F / float(base)};
+    float factor{inv_base};
+    float result{0.F};
+    while(i > 0U) {
+        result += factor * float(i % base);
+        i /= base;
+        factor *= inv_base;
+    }
+    return result;
+}
+//------------------------------------------------------------------------------
+// Counter-based random number generator (splitmix64) keyed by the seed
+// and the vertex index, independent of the thread tracing the vertex.
+class occlusion_random {
+public:
+    occlusion_random(const std::uint64_t seed, const std::uint64_t key) noexcept
+      : _state{_mix(seed) ^ _mix(key + 0x9E3779B97F4A7C15ULL)} {}
+
+    // returns the next uniformly distributed value in [0, 1)
+    auto get() noexcept -> float {
+        _state += 0x9E3779B97F4A7C15ULL;
+        return float(_mix(_state) >> 40U) * 0x1.0p-24F;
+    }
+
+private:
+    static constexpr auto _mix(std::uint64_t z) noexcept -> std::uint64_t {
+        z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31U);
+    }
+
+    std::uint64_t _state;
+};
+//------------------------------------------------------------------------------
+static auto occlusion_vertex_order(
+  const span<const float> positions,
+  const span_size_t vbegin,
+  const span_size_t vend) -> std::vector<span_size_t> {
+    std::array<float, 3> min{
+      std::numeric_limits<float>::max(),
+      std::numeric_limits<float>::max(),
+      std::numeric_limits<float>::max()};
+    std::array<float, 3> max{
+      std::numeric_limits<float>::lowest(),
+      std::numeric_limits<float>::lowest(),
+      std::numeric_limits<float>::lowest()};
+    for(const auto v : integer_range(vbegin, vend)) {
+        for(const auto c : integer_range(std_size(3))) {
+            const auto p = positions[std_size(v * 3) + c];
+            min[c] = math::minimum(min[c], p);
+            max[c] = math::maximum(max[c], p);
+        }
+    }
+
+    const auto spread_bits{[](std::uint32_t x) -> std::uint32_t {
+        x &= 0x3FFU;
+        x = (x | (x << 16U)) & 0x030000FFU;
+        x = (x | (x << 8U)) & 0x0300F00FU;
+        x = (x | (x << 4U)) & 0x030C30C3U;
+        x = (x | (x << 2U)) & 0x09249249U;
+        return x;
+    }};
+
+    std::vector<std::tuple<std::uint32_t, span_size_t>> keyed;
+    keyed.reserve(std_size(vend - vbegin));
+    for(const auto v : integer_range(vbegin, vend)) {
+        std::uint32_t code{0U};
+        for(const auto c : integer_range(std_size(3))) {
+            const auto extent = max[c] - min[c];
+            const auto p = positions[std_size(v * 3) + c];
+            const auto q =
+              extent > 0.F ? std::uint32_t((p - min[c]) / extent * 1023.F)
+                           : 0U;
+            code |= spread_bits(q) << c;
+        }
+        keyed.emplace_back(code, v);
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    std::vector<span_size_t> result;
+    result.reserve(keyed.size());
+    for(const auto& entry : keyed) {
+        result.push_back(std::get<1>(entry));
+    }
+    return result;
+}
+//------------------------------------------------------------------------------
+static auto occlusion_cache_options(const occlusion_options& opts)
+  -> cache_options {
+    cache_options result;
+    result.instrumentation = opts.instrumentation;
+    return result;
 }
 //------------------------------------------------------------------------------
 occluded_gen::occluded_gen(
   shared_holder<generator> gen,
-  const span_size_t samples,
+  const occlusion_options& opts,
   main_ctx_parent parent) noexcept
   : main_ctx_object{"OcclShpGen", parent}
-  , delegated_gen{cache(std::move(gen), this->as_parent())}
-  , _samples{samples} {
+  , delegated_gen{cache(
+      std::move(gen),
+      occlusion_cache_options(opts),
+      this->as_parent())}
+  , _options{opts}
+  , _instr_node{
+      opts.instrumentation ? &opts.instrumentation->add_node("occlusion")
+                           : nullptr} {
     delegated_gen::_add(vertex_attrib_kind::occlusion);
 }
 //------------------------------------------------------------------------------
-void occluded_gen::occlusions(
-  const vertex_attrib_variant vav,
-  span<float> dest) {
+void occluded_gen::_trace() {
+    // the occlusion has only one variant, so the inputs use the first one
+    const vertex_attrib_variant vav{vertex_attrib_kind::occlusion};
     const auto vc = delegated_gen::vertex_count();
     const auto pva = vertex_attrib_kind::position;
     const auto nva = vertex_attrib_kind::normal;
     const auto pvpv = delegated_gen::values_per_vertex({pva, vav});
     const auto nvpv = delegated_gen::values_per_vertex({nva, vav});
-    const auto ns = _samples;
+    const auto ns = _options.samples;
+    const auto sampling = _options.sampling;
+    const auto cosine_weighted = _options.cosine_weighted;
+    const auto tolerance = _options.tolerance;
 
-    if((pvpv == 3) and (nvpv == 3)) {
-        assert(dest.size() >= vc * delegated_gen::values_per_vertex(vav));
+    std::vector<float> occl_values(std_size(vc), 0.F);
+    std::vector<float> bent_values(std_size(vc * 3), 0.F);
 
-        std::vector<float> positions(std_size(vc * pvpv));
-        std::vector<float> normals(std_size(vc * nvpv));
+    if((pvpv == 3) and (nvpv == 3) and (ns > 0)) {
+        const auto start{std::chrono::steady_clock::now()};
+        auto& base = *delegated_gen::base_generator();
+        const auto positions{shared_attrib_values<float>(base, {pva, vav})};
+        const auto normals{shared_attrib_values<float>(base, {nva, vav})};
+        // vertices outside of the traced range keep the original normal
+        bent_values.assign(normals.begin(), normals.end());
 
-        delegated_gen::attrib_values({pva, vav}, cover(positions));
-        delegated_gen::attrib_values({nva, vav}, cover(normals));
+        // the triangles are prepared once and shared by all ray-tracers
+        const ray_query_context query{base, 0};
+        // the range of vertices for which the occlusions are computed
+        const auto vbegin = math::minimum(
+          math::maximum(_options.first_vertex, span_size(0)), vc);
+        const auto vend = math::maximum(
+          math::minimum(
+            _options.vertex_count ? vbegin + *_options.vertex_count : vc, vc),
+          vbegin);
+        const auto vrc = vend - vbegin;
 
-        std::atomic<span_size_t> vi{0};
-        std::random_device rd;
+        // the vertices are traced in chunks following a Z-order curve
+        // through their positions, so that each worker traces vertices
+        // that are close to each other and hit the same shape triangles
+        const auto order{
+          occlusion_vertex_order(positions.values(), vbegin, vend)};
+        const span_size_t chunk_size{32};
+        std::atomic<span_size_t> next_chunk{0};
+        std::atomic<span_size_t> completed{0};
+        // without an explicit seed each bake uses a different one
+        const auto seed{
+          _options.seed.value_or(std::random_device{}() * 0x100000001ULL)};
+
+        // the plain random sampling also traces the ray along the normal
+        const span_size_t ns0 =
+          ((sampling == occlusion_sampling::random) and not cosine_weighted)
+            ? 1
+            : 0;
+        // the dimensions of the grid used in stratified sampling
+        const auto nsx = math::maximum(
+          span_size(std::sqrt(float(ns - ns0))), span_size(1));
+        const auto nsy = (ns - ns0 + nsx - 1) / nsx;
+        // the number of rays traced at once before checking the convergence
+        const auto nsb = tolerance > 0.F
+                           ? math::maximum(_options.batch_size, span_size(1))
+                           : ns;
+        std::atomic<span_size_t> total_traced{0};
 
         const auto make_raytracer{[&](auto progress_update) {
-            return [this,
-                    &dest,
+            return [&query,
+                    &occl_values,
+                    &bent_values,
                     &positions,
                     &normals,
-                    &vi,
-                    vc,
+                    &order,
+                    &next_chunk,
+                    &completed,
+                    &total_traced,
+                    vrc,
+                    chunk_size,
                     ns,
+                    ns0,
+                    nsx,
+                    nsy,
+                    nsb,
+                    sampling,
+                    cosine_weighted,
+                    tolerance,
                     pvpv,
                     nvpv,
-                    progress_update{std::move(progress_update)},
-                    rho_rs{rd()},
-                    phi_rs{rd()}]() {
-                std::default_random_engine rho_re{rho_rs};
-                std::default_random_engine phi_re{phi_rs};
-                std::uniform_real_distribution<double> dis{0.0, 1.0};
+                    seed,
+                    progress_update{std::move(progress_update)}]() {
+                occlusion_random rnd{seed, 0U};
 
                 std::vector<math::line<float>> rays(std_size(ns));
                 std::vector<float> weights(rays.size());
                 std::vector<optionally_valid<float>> params(rays.size());
+                std::vector<span_size_t> strata(
+                  sampling == occlusion_sampling::stratified
+                    ? std_size(nsx * nsy)
+                    : 0U);
+                span_size_t traced{0};
+
+                const auto sample_point{
+                  [&](const span_size_t k,
+                      const float ru,
+                      const float rv) -> std::array<float, 2> {
+                      switch(sampling) {
+                          case occlusion_sampling::stratified: {
+                              const auto c = strata[std_size(k)];
+                              return {
+                                (float(c % nsx) + rnd.get()) / float(nsx),
+                                (float(c / nsx) + rnd.get()) / float(nsy)};
+                          }
+                          case occlusion_sampling::halton: {
+                              const auto i = limit_cast<std::uint32_t>(k + 1);
+                              const auto u =
+                                occlusion_radical_inverse(2U, i) + ru;
+                              const auto v =
+                                occlusion_radical_inverse(3U, i) + rv;
+                              return {u - std::floor(u), v - std::floor(v)};
+                          }
+                          case occlusion_sampling::random:
+                              break;
+                      }
+                      return {rnd.get(), rnd.get()};
+                  }};
 
                 const auto vertex_occlusion{[&](const auto v) -> float {
+                    // the sequence depends only on the seed and the vertex
+                    rnd = occlusion_random{seed, std::uint64_t(v)};
                     const auto pk = std_size(v * pvpv);
                     const auto nk = std_size(v * nvpv);
                     const math::point<float, 3> pos{
                       positions[pk + 0], positions[pk + 1], positions[pk + 2]};
-                    const math::vector<float, 3> nml{
+
+                    std::array<float, 3> n{
                       normals[nk + 0], normals[nk + 1], normals[nk + 2]};
+                    const auto nl =
+                      std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                    if(nl > 0.F) {
+                        for(auto& c : n) {
+                            c /= nl;
+                        }
+                    }
+                    // orthonormal tangent frame around the normal
+                    const auto sign = std::copysign(1.F, n[2]);
+                    const auto a = -1.F / (sign + n[2]);
+                    const auto b = n[0] * n[1] * a;
+                    const std::array<float, 3> t{
+                      1.F + sign * n[0] * n[0] * a, sign * b, -sign * n[0]};
+                    const std::array<float, 3> bt{
+                      b, sign + n[1] * n[1] * a, -n[1]};
 
-                    rays[0] = math::line<float>{pos, nml};
-                    weights[0] = 1.F;
+                    if(ns0 > 0) {
+                        rays[0] = math::line<float>{
+                          pos, math::vector<float, 3>{n[0], n[1], n[2]}};
+                        weights[0] = 1.F;
+                    }
 
-                    for(const auto s : integer_range(1, ns)) {
-                        const math::unit_spherical_coordinate<float> usc{
-                          turns_(float(dis(rho_re))),
-                          radians_(float(std::acos(2 * dis(phi_re) - 1)))};
+                    // per-vertex rotation of the low-discrepancy sequence
+                    const auto ru = rnd.get();
+                    const auto rv = rnd.get();
 
-                        auto dir = math::to_cartesian(usc);
-                        auto wght = dot(dir, nml);
+                    // the strata are traced in a per-vertex random order,
+                    // so that the rays traced before an early termination
+                    // are not limited to a wedge of the azimuth angles
+                    if(not strata.empty()) {
+                        std::iota(strata.begin(), strata.end(), span_size_t(0));
+                        for(auto i = span_size(strata.size()) - 1; i > 0; --i) {
+                            const auto j = math::minimum(
+                              span_size_t(rnd.get() * float(i + 1)), i);
+                            std::swap(strata[std_size(i)], strata[std_size(j)]);
+                        }
+                    }
 
-                        if(wght < 0.F) {
-                            dir = -dir;
-                            wght = -wght;
+                    const auto make_ray{[&](const span_size_t s) {
+                        const auto [u1, u2] = sample_point(s - ns0, ru, rv);
+                        float z{u1};
+                        float wght{u1};
+                        if(cosine_weighted) {
+                            z = std::sqrt(math::maximum(1.F - u1, 0.F));
+                            wght = 1.F;
                         }
+                        const auto r =
+                          std::sqrt(math::maximum(1.F - z * z, 0.F));
+                        const auto phi = 2.F * std::numbers::pi_v<float> * u2;
+                        const auto x = r * std::cos(phi);
+                        const auto y = r * std::sin(phi);
 
-                        rays[s] = math::line<float>{pos, dir};
+                        rays[s] = math::line<float>{
+                          pos,
+                          math::vector<float, 3>{
+                            t[0] * x + bt[0] * y + n[0] * z,
+                            t[1] * x + bt[1] * y + n[1] * z,
+                            t[2] * x + bt[2] * y + n[2] * z}};
                         weights[s] = wght;
-                    }
-                    fill(cover(params), optionally_valid<float>{});
-                    delegated_gen::ray_intersections(
-                      *this, 0, view(rays), cover(params));
+                    }};
 
+                    // weighted sums of the ray occlusions, their squares,
+                    // of the weights and of the squared weights
                     float occl = 0.F;
+                    float occl2 = 0.F;
                     float wght = 0.F;
-                    for(const auto s : integer_range(ns)) {
-                        if(params[s] > 0.0F) {
-                            const auto aip = *params[s];
-                            occl += (std::exp(-0.25F * aip) +
-                                     std::exp(-0.125F * aip) +
-                                     std::exp(-0.03125F * aip) +
-                                     std::exp(-0.0078125F * aip)) *
-                                    0.25F * weights[s];
+                    float wght2 = 0.F;
+                    // sum of the directions of the rays hitting nothing
+                    std::array<float, 3> bent{0.F, 0.F, 0.F};
+
+                    span_size_t done{0};
+                    while(done < ns) {
+                        const auto todo = math::minimum(ns - done, nsb);
+                        const auto first = math::maximum(done, ns0);
+                        for(const auto s : integer_range(first, done + todo)) {
+                            make_ray(s);
+                        }
+                        auto batch_params{
+                          head(skip(cover(params), done), todo)};
+                        fill(batch_params, optionally_valid<float>{});
+                        query.ray_intersections(
+                          head(skip(view(rays), done), todo), batch_params);
+
+                        for(const auto s : integer_range(done, done + todo)) {
+                            float rocl{0.F};
+                            if(params[s] > 0.0F) {
+                                const auto aip = *params[s];
+                                rocl = (std::exp(-0.25F * aip) +
+                                        std::exp(-0.125F * aip) +
+                                        std::exp(-0.03125F * aip) +
+                                        std::exp(-0.0078125F * aip)) *
+                                       0.25F;
+                            } else {
+                                // weighted like the occlusion, so that the
+                                // bent normal does not depend on whether the
+                                // directions are cosine-distributed
+                                const auto dir = rays[s].direction();
+                                bent[0] += dir.x() * weights[s];
+                                bent[1] += dir.y() * weights[s];
+                                bent[2] += dir.z() * weights[s];
+                            }
+                            occl += rocl * weights[s];
+                            occl2 += rocl * rocl * weights[s];
+                            wght += weights[s];
+                            wght2 += weights[s] * weights[s];
+                        }
+                        done += todo;
+
+                        // stop when the 95% confidence interval of the
+                        // weighted mean is narrower than the tolerance
+                        if((tolerance > 0.F) and (done >= 2 * nsb) and
+                           (wght2 > 0.F)) {
+                            const auto mean = occl / wght;
+                            const auto var =
+                              math::maximum(occl2 / wght - mean * mean, 0.F);
+                            const auto eff = (wght * wght) / wght2;
+                            if(1.96F * std::sqrt(var / eff) < tolerance) {
+                                break;
+                            }
                         }
-                        wght += weights[s];
                     }
-                    return occl / wght;
+                    traced += done;
+
+                    const auto bl = std::sqrt(
+                      bent[0] * bent[0] + bent[1] * bent[1] +
+                      bent[2] * bent[2]);
+                    for(const auto c : integer_range(std_size(3))) {
+                        bent_values[std_size(v * 3) + c] =
+                          bl > 0.F ? bent[c] / bl : n[c];
+                    }
+                    return wght > 0.F ? occl / wght : 0.F;
                 }};
 
                 while(true) {
-                    const auto v = vi++;
-                    if(v < vc) {
-                        dest[v] = vertex_occlusion(v);
-                        if(not progress_update(v)) [[unlikely]] {
-                            break;
-                        }
-                    } else {
+                    const auto first = next_chunk.fetch_add(chunk_size);
+                    if(first >= vrc) {
+                        break;
+                    }
+                    const auto last = math::minimum(first + chunk_size, vrc);
+                    for(const auto k : integer_range(first, last)) {
+                        const auto v = order[std_size(k)];
+                        occl_values[std_size(v)] = vertex_occlusion(v);
+                    }
+                    if(not progress_update(completed += last - first))
+                      [[unlikely]] {
                         break;
                     }
                 }
+                total_traced += traced;
                 return true;
             };
         }};
 
-        const inplace_work_batch raytrace{
-          workers(), make_raytracer([](const auto) { return true; })};
+        const auto trace_here{[&] {
+            make_raytracer(
+              [raytracing{progress().activity("ray-tracing occlusions", vrc)}](
+                const auto v) { return raytracing.update_progress(v); })();
+            next_chunk = vrc;
+        }};
+        if(_options.parallel) {
+            const inplace_work_batch raytrace{
+              workers(), make_raytracer([](const auto) { return true; })};
+            trace_here();
+        } else {
+            trace_here();
+        }
+
+        log_info("ray-traced vertex occlusions")
+          .arg("first", vbegin)
+          .arg("vertices", vrc)
+          .arg("maxSamples", ns)
+          .arg("avgSamples", vrc > 0 ? float(total_traced) / float(vrc) : 0.F);
+        // the rays are traced directly by the query, not by the generators
+        if(_instr_node) {
+            _instr_node->ray_intersections.add_rays(
+              total_traced,
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start));
+        }
+    } else if(nvpv == 3) {
+        delegated_gen::attrib_values({nva, vav}, cover(bent_values));
+    }
 
-        make_raytracer(
-          [raytracing{progress().activity("ray-tracing occlusions", vc)}](
-            const auto v) { return raytracing.update_progress(v); })();
-        vi = vc;
-    } else {
-        fill(dest, 0.F);
+    _occlusions = std::move(occl_values);
+    _bent_normals = std::move(bent_values);
+    _traced = true;
+}
+//------------------------------------------------------------------------------
+void occluded_gen::occlusions(const vertex_attrib_variant, span<float> dest) {
+    const std::lock_guard<std::mutex> lock{_mutex};
+    if(not _traced) {
+        _trace();
+    }
+    copy(view(_occlusions), dest);
+}
+//------------------------------------------------------------------------------
+void occluded_gen::bent_normals(span<float> dest) {
+    const std::lock_guard<std::mutex> lock{_mutex};
+    if(not _traced) {
+        _trace();
+    }
+    copy(view(_bent_normals), dest);
+}
+//------------------------------------------------------------------------------
+auto occluded_gen::_bent_normal_variant() -> vertex_attrib_variant {
+    const auto nva = vertex_attrib_kind::normal;
+    return {nva, delegated_gen::attribute_variants(nva)};
+}
+//------------------------------------------------------------------------------
+auto occluded_gen::_is_bent_normal(const vertex_attrib_variant vav) -> bool {
+    return _options.bent_normals and
+           (vav.attribute() == vertex_attrib_kind::normal) and
+           (vav.index() == _bent_normal_variant().index());
+}
+//------------------------------------------------------------------------------
+auto occluded_gen::attribute_variants(const vertex_attrib_kind attrib)
+  -> span_size_t {
+    const auto count = delegated_gen::attribute_variants(attrib);
+    if(_options.bent_normals and (attrib == vertex_attrib_kind::normal)) {
+        return count + 1;
+    }
+    return count;
+}
+//------------------------------------------------------------------------------
+auto occluded_gen::variant_name(const vertex_attrib_variant vav)
+  -> string_view {
+    if(_is_bent_normal(vav)) {
+        return {"bent"};
+    }
+    return delegated_gen::variant_name(vav);
+}
+//------------------------------------------------------------------------------
+auto occluded_gen::find_variant(
+  const vertex_attrib_kind attrib,
+  const string_view name) -> vertex_attrib_variant {
+    if(_options.bent_normals and (attrib == vertex_attrib_kind::normal)) {
+        if(are_equal(name, string_view{"bent"})) {
+            return _bent_normal_variant();
+        }
+    }
+    return delegated_gen::find_variant(attrib, name);
+}
+//------------------------------------------------------------------------------
+auto occluded_gen::attrib_type(const vertex_attrib_variant vav)
+  -> attrib_data_type {
+    if(_is_bent_normal(vav)) {
+        return attrib_data_type::float_;
     }
+    return delegated_gen::attrib_type(vav);
 }
 //------------------------------------------------------------------------------
 void occluded_gen::attrib_values(
@@ -173,9 +669,131 @@ void occluded_gen::attrib_values(
 
     if(vav == vertex_attrib_kind::occlusion) {
         occlusions(vav, dest);
+    } else if(_is_bent_normal(vav)) {
+        bent_normals(dest);
     } else {
         delegated_gen::attrib_values(vav, dest);
     }
 }
 //------------------------------------------------------------------------------
+// occlusion shards
+//------------------------------------------------------------------------------
+static constexpr const std::array<char, 8> occlusion_shard_magic{
+  'E', 'A', 'G', 'O', 'C', 'C', 'L', '1'};
+//------------------------------------------------------------------------------
+auto make_occlusion_shard(generator& gen, const occlusion_options& opts)
+  -> occlusion_shard {
+    occlusion_shard result;
+    const auto vc = gen.vertex_count();
+    const auto vbegin =
+      math::minimum(math::maximum(opts.first_vertex, span_size(0)), vc);
+    const auto vend = math::maximum(
+      math::minimum(opts.vertex_count ? vbegin + *opts.vertex_count : vc, vc),
+      vbegin);
+
+    std::vector<float> values(std_size(vc));
+    gen.attrib_values(vertex_attrib_kind::occlusion, cover(values));
+
+    result.total_vertex_count = vc;
+    result.first_vertex = vbegin;
+    result.values.assign(
+      std::next(values.begin(), vbegin), std::next(values.begin(), vend));
+    return result;
+}
+//------------------------------------------------------------------------------
+auto write_occlusion_shard(std::ostream& out, const occlusion_shard& shard)
+  -> std::ostream& {
+    const std::array<std::uint64_t, 3> header{
+      limit_cast<std::uint64_t>(shard.total_vertex_count),
+      limit_cast<std::uint64_t>(shard.first_vertex),
+      limit_cast<std::uint64_t>(shard.values.size())};
+    out.write(occlusion_shard_magic.data(), occlusion_shard_magic.size());
+    out.write(
+      reinterpret_cast<const char*>(header.data()),
+      std::streamsize(sizeof(header)));
+    out.write(
+      reinterpret_cast<const char*>(shard.values.data()),
+      std::streamsize(shard.values.size() * sizeof(float)));
+    return out;
+}
+//------------------------------------------------------------------------------
+auto read_occlusion_shard(std::istream& inp, occlusion_shard& shard) -> bool {
+    std::array<char, 8> magic{};
+    std::array<std::uint64_t, 3> header{};
+    if(not inp.read(magic.data(), magic.size())) {
+        return false;
+    }
+    if(magic != occlusion_shard_magic) {
+        return false;
+    }
+    if(not inp.read(
+         reinterpret_cast<char*>(header.data()),
+         std::streamsize(sizeof(header)))) {
+        return false;
+    }
+    const auto [vc, first, count] = header;
+    if((first > vc) or (count > vc - first)) {
+        return false;
+    }
+    shard.total_vertex_count = limit_cast<span_size_t>(vc);
+    shard.first_vertex = limit_cast<span_size_t>(first);
+    shard.values.resize(std_size(count));
+    return bool(inp.read(
+      reinterpret_cast<char*>(shard.values.data()),
+      std::streamsize(shard.values.size() * sizeof(float))));
+}
+//------------------------------------------------------------------------------
+class baked_occlusion_gen : public delegated_gen {
+public:
+    baked_occlusion_gen(
+      shared_holder<generator> gen,
+      std::vector<float> values) noexcept
+      : delegated_gen{std::move(gen)}
+      , _values{std::move(values)} {
+        delegated_gen::_add(vertex_attrib_kind::occlusion);
+    }
+
+    void attrib_values(const vertex_attrib_variant vav, span<float> dest)
+      override {
+        if(vav == vertex_attrib_kind::occlusion) {
+            copy(view(_values), dest);
+        } else {
+            delegated_gen::attrib_values(vav, dest);
+        }
+    }
+
+private:
+    std::vector<float> _values;
+};
+//------------------------------------------------------------------------------
+auto merge_occlusion_shards(
+  shared_holder<generator> gen,
+  const span<const occlusion_shard> shards) noexcept
+  -> shared_holder<generator> {
+    const auto vc = gen->vertex_count();
+    std::vector<float> values(std_size(vc), 0.F);
+    std::vector<bool> covered(std_size(vc), false);
+
+    for(const auto& shard : shards) {
+        const auto count = span_size(shard.values.size());
+        if(
+          (shard.total_vertex_count != vc) or (shard.first_vertex < 0) or
+          (shard.first_vertex + count > vc)) {
+            return {};
+        }
+        for(const auto i : integer_range(count)) {
+            const auto v = std_size(shard.first_vertex + i);
+            if(covered[v]) {
+                return {};
+            }
+            covered[v] = true;
+            values[v] = shard.values[std_size(i)];
+        }
+    }
+    if(not std::all_of(covered.begin(), covered.end(), std::identity{})) {
+        return {};
+    }
+    return {hold<baked_occlusion_gen>, std::move(gen), std::move(values)};
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
@@ -0,0 +1,141 @@
+/// @file
+///
+/// Copyright Matus Chochlik.
+/// Distributed under the Boost Software License, Version 1.0.
+/// See accompanying file LICENSE_1_0.txt or copy at
+/// https://www.boost.org/LICENSE_1_0.txt
+///
+export module eagine.shapes:occlusion;
+
+import std;
+import eagine.core.types;
+import eagine.core.memory;
+import eagine.core.reflection;
+import eagine.core.main_ctx;
+import :generator;
+
+namespace eagine {
+namespace shapes {
+//------------------------------------------------------------------------------
+/// @brief Enumeration of strategies for sampling the occlusion ray directions.
+/// @ingroup shapes
+/// @see occlusion_options
+export enum class occlusion_sampling : std::uint8_t {
+    /// @brief Independent uniformly distributed random directions.
+    random,
+    /// @brief Jittered directions, one in each cell of a regular grid.
+    stratified,
+    /// @brief Halton sequence with per-vertex Cranley-Patterson rotation.
+    halton
+};
+} // namespace shapes
+export template <>
+struct enumerator_traits<shapes::occlusion_sampling> {
+    static constexpr auto mapping() noexcept {
+        using shapes::occlusion_sampling;
+        return enumerator_map_type<occlusion_sampling, 3>{
+          {{"random", occlusion_sampling::random},
+           {"stratified", occlusion_sampling::stratified},
+           {"halton", occlusion_sampling::halton}}};
+    }
+};
+namespace shapes {
+//------------------------------------------------------------------------------
+/// @brief Options controlling the computation of vertex occlusions.
+/// @ingroup shapes
+/// @see occlude
+export struct occlusion_options {
+    /// @brief The number of rays traced per vertex.
+    span_size_t samples{64};
+    /// @brief The strategy for sampling the ray directions.
+    occlusion_sampling sampling{occlusion_sampling::random};
+    /// @brief Indicates if the directions should be cosine-distributed.
+    bool cosine_weighted{false};
+    /// @brief Confidence interval width at which the tracing of a vertex stops.
+    /// @note Zero disables the early termination, all samples are traced then.
+    float tolerance{0.F};
+    /// @brief The number of rays traced between the convergence checks.
+    span_size_t batch_size{16};
+    /// @brief Seed making the results reproducible.
+    /// @note With the same seed the results do not depend on the thread count.
+    std::optional<std::uint64_t> seed{};
+    /// @brief Index of the first vertex for which the occlusion is computed.
+    span_size_t first_vertex{0};
+    /// @brief The number of vertices for which the occlusion is computed.
+    /// @note If not set, occlusions up to the last vertex are computed.
+    std::optional<span_size_t> vertex_count{};
+    /// @brief Indicates if a "bent" normal attribute variant should be added.
+    /// @note The bent normals are computed from the same rays as the occlusions.
+    bool bent_normals{false};
+    /// @brief Indicates if the rays are traced also on the context workers.
+    /// @note With a seed the results are the same either way.
+    bool parallel{true};
+    /// @brief Optional instrumentation recording the traced rays.
+    /// @note The rays are recorded under the "occlusion" node, the wrapped
+    /// generator is cached with the same instrumentation.
+    std::shared_ptr<generator_instrumentation> instrumentation{};
+
+    occlusion_options() noexcept = default;
+    explicit occlusion_options(const span_size_t s) noexcept
+      : samples{s} {}
+};
+//------------------------------------------------------------------------------
+/// @brief Parses the occlusion options from the program arguments.
+/// @ingroup shapes
+export auto parse_from(main_ctx&, occlusion_options&) noexcept -> bool;
+
+/// @brief Returns a string describing the options for the persistent_cache key.
+/// @ingroup shapes
+/// @see persistent_cache
+///
+/// Without a seed the persisted occlusions are one of the possible random
+/// results, which are then reused instead of being re-computed on every run.
+export auto persistent_cache_key(const occlusion_options&) -> std::string;
+//------------------------------------------------------------------------------
+/// @brief Constructs instances of occluded_gen modifier.
+/// @ingroup shapes
+export [[nodiscard]] auto occlude(
+  shared_holder<generator> gen,
+  const occlusion_options& opts,
+  main_ctx_parent parent) noexcept -> shared_holder<generator>;
+//------------------------------------------------------------------------------
+/// @brief Occlusion values computed for a contiguous range of shape vertices.
+/// @ingroup shapes
+/// @see make_occlusion_shard
+/// @see merge_occlusion_shards
+export struct occlusion_shard {
+    /// @brief The total number of vertices of the shape.
+    span_size_t total_vertex_count{0};
+    /// @brief Index of the first vertex in this shard.
+    span_size_t first_vertex{0};
+    /// @brief The occlusion values of the vertices in this shard.
+    std::vector<float> values;
+};
+//------------------------------------------------------------------------------
+/// @brief Gets the vertex range specified in opts from an occlusion generator.
+/// @ingroup shapes
+/// @see occlude
+export auto make_occlusion_shard(generator& gen, const occlusion_options& opts)
+  -> occlusion_shard;
+
+/// @brief Writes the occlusion shard in binary format into an output stream.
+/// @ingroup shapes
+export auto write_occlusion_shard(std::ostream&, const occlusion_shard&)
+  -> std::ostream&;
+
+/// @brief Reads the occlusion shard in binary format from an input stream.
+/// @ingroup shapes
+export auto read_occlusion_shard(std::istream&, occlusion_shard&) -> bool;
+
+/// @brief Adds occlusions merged from shards covering all vertices of gen.
+/// @ingroup shapes
+/// @see make_occlusion_shard
+///
+/// Returns an empty holder if the shards do not cover each vertex exactly once.
+export [[nodiscard]] auto merge_occlusion_shards(
+  shared_holder<generator> gen,
+  const span<const occlusion_shard> shards) noexcept
+  -> shared_holder<generator>;
+//------------------------------------------------------------------------------
+} // namespace shapes
+} // namespace eagine
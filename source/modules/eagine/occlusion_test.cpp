@@ -0,0 +1,305 @@
+/// @file
+///
+/// Copyright Matus Chochlik.
+/// Distributed under the Boost Software License, Version 1.0.
+/// See accompanying file LICENSE_1_0.txt or copy at
+/// https://www.boost.org/LICENSE_1_0.txt
+///
+
+#include <eagine/testing/unit_begin_ctx.hpp>
+import std;
+import eagine.core;
+import eagine.shapes;
+//------------------------------------------------------------------------------
+auto occlusion_test_shape() {
+    using eagine::shapes::vertex_attrib_kind;
+    return eagine::shapes::unit_twisted_torus(
+      vertex_attrib_kind::position | vertex_attrib_kind::normal,
+      6,
+      12,
+      8,
+      0.5F);
+}
+//------------------------------------------------------------------------------
+auto occlusion_values(
+  eagine::shared_holder<eagine::shapes::generator> gen,
+  const eagine::shapes::occlusion_options& opts,
+  eagine::main_ctx& ctx) -> std::vector<float> {
+    using eagine::shapes::vertex_attrib_kind;
+    auto occl{eagine::shapes::occlude(std::move(gen), opts, ctx)};
+    std::vector<float> result(
+      std::size_t(occl->value_count(vertex_attrib_kind::occlusion)));
+    occl->attrib_values(vertex_attrib_kind::occlusion, eagine::cover(result));
+    return result;
+}
+//------------------------------------------------------------------------------
+auto occlusion_mean(const std::vector<float>& values) -> float {
+    return std::accumulate(values.begin(), values.end(), 0.F) /
+           float(values.size());
+}
+//------------------------------------------------------------------------------
+auto occlusion_difference(
+  const std::vector<float>& l,
+  const std::vector<float>& r) -> float {
+    float result{0.F};
+    for(const auto i : eagine::integer_range(l.size())) {
+        result += std::abs(l[i] - r[i]);
+    }
+    return result / float(l.size());
+}
+//------------------------------------------------------------------------------
+void occlusion_sampling_strategies(auto& s) {
+    eagitest::case_ test{s, 1, "sampling strategies"};
+    using eagine::shapes::occlusion_sampling;
+
+    eagine::shapes::occlusion_options opts{256};
+    opts.seed = 1234U;
+    const auto expected{
+      occlusion_values(occlusion_test_shape(), opts, s.context())};
+    test.ensure(not expected.empty(), "has values");
+    for(const auto value : expected) {
+        test.check(value >= 0.F and value <= 1.F, "in range");
+    }
+
+    const auto check{[&](const auto& other, const char* name) {
+        const auto values{
+          occlusion_values(occlusion_test_shape(), other, s.context())};
+        test.ensure(values.size() == expected.size(), "value count");
+        test.check(
+          std::abs(occlusion_mean(values) - occlusion_mean(expected)) < 0.03F,
+          name);
+        test.check(occlusion_difference(values, expected) < 0.1F, name);
+    }};
+
+    auto stratified{opts};
+    stratified.sampling = occlusion_sampling::stratified;
+    check(stratified, "stratified");
+
+    auto halton{opts};
+    halton.sampling = occlusion_sampling::halton;
+    check(halton, "halton");
+
+    auto cosine{opts};
+    cosine.cosine_weighted = true;
+    check(cosine, "cosine weighted");
+}
+//------------------------------------------------------------------------------
+void occlusion_early_termination(auto& s) {
+    eagitest::case_ test{s, 2, "early termination"};
+
+    eagine::shapes::occlusion_options opts{256};
+    opts.sampling = eagine::shapes::occlusion_sampling::stratified;
+    opts.seed = 2345U;
+    const auto full{
+      occlusion_values(occlusion_test_shape(), opts, s.context())};
+
+    opts.tolerance = 0.05F;
+    opts.batch_size = 16;
+    const auto early{
+      occlusion_values(occlusion_test_shape(), opts, s.context())};
+    test.ensure(early.size() == full.size(), "value count");
+    test.check(
+      std::abs(occlusion_mean(early) - occlusion_mean(full)) < 0.02F,
+      "unbiased mean");
+    test.check(occlusion_difference(early, full) < 0.05F, "close values");
+}
+//------------------------------------------------------------------------------
+void occlusion_reproducible(auto& s) {
+    eagitest::case_ test{s, 3, "reproducible"};
+
+    eagine::shapes::occlusion_options opts{64};
+    opts.seed = 3456U;
+    for(const auto sampling :
+        {eagine::shapes::occlusion_sampling::random,
+         eagine::shapes::occlusion_sampling::stratified,
+         eagine::shapes::occlusion_sampling::halton}) {
+        opts.sampling = sampling;
+        opts.tolerance = 0.1F;
+        opts.parallel = true;
+        const auto parallel{
+          occlusion_values(occlusion_test_shape(), opts, s.context())};
+        opts.parallel = false;
+        const auto serial{
+          occlusion_values(occlusion_test_shape(), opts, s.context())};
+        test.check(not serial.empty(), "has values");
+        test.check(parallel == serial, "same values on one thread");
+    }
+}
+//------------------------------------------------------------------------------
+void occlusion_shards(auto& s) {
+    eagitest::case_ test{s, 4, "shards"};
+    using eagine::shapes::vertex_attrib_kind;
+
+    eagine::shapes::occlusion_options opts{64};
+    opts.seed = 4567U;
+    const auto expected{
+      occlusion_values(occlusion_test_shape(), opts, s.context())};
+    const auto vc{eagine::span_size(expected.size())};
+    test.ensure(vc > 2, "has vertices");
+
+    const auto make_shard{[&](eagine::span_size_t first,
+                              eagine::span_size_t count) {
+        auto shard_opts{opts};
+        shard_opts.first_vertex = first;
+        shard_opts.vertex_count = count;
+        auto occl{eagine::shapes::occlude(
+          occlusion_test_shape(), shard_opts, s.context())};
+        std::stringstream blob;
+        eagine::shapes::write_occlusion_shard(
+          blob, eagine::shapes::make_occlusion_shard(*occl, shard_opts));
+        eagine::shapes::occlusion_shard result;
+        test.check(
+          eagine::shapes::read_occlusion_shard(blob, result), "read shard");
+        test.check(result.first_vertex == first, "first vertex");
+        test.check(eagine::span_size(result.values.size()) == count, "count");
+        return result;
+    }};
+
+    const auto half{vc / 2};
+    const std::array<eagine::shapes::occlusion_shard, 2> shards{
+      {make_shard(half, vc - half), make_shard(0, half)}};
+    auto merged{eagine::shapes::merge_occlusion_shards(
+      occlusion_test_shape(), eagine::view(shards))};
+    test.ensure(bool(merged), "merged");
+    std::vector<float> values(expected.size());
+    merged->attrib_values(vertex_attrib_kind::occlusion, eagine::cover(values));
+    test.check(values == expected, "same as single bake");
+
+    const std::array<eagine::shapes::occlusion_shard, 2> overlap{
+      {make_shard(0, half + 1), make_shard(half, vc - half)}};
+    test.check(
+      not eagine::shapes::merge_occlusion_shards(
+        occlusion_test_shape(), eagine::view(overlap)),
+      "overlap rejected");
+
+    const std::array<eagine::shapes::occlusion_shard, 2> gap{
+      {make_shard(0, half - 1), make_shard(half, vc - half)}};
+    test.check(
+      not eagine::shapes::merge_occlusion_shards(
+        occlusion_test_shape(), eagine::view(gap)),
+      "gap rejected");
+
+    std::stringstream truncated;
+    eagine::shapes::write_occlusion_shard(truncated, shards[0]);
+    std::stringstream partial{truncated.str().substr(0, 20)};
+    eagine::shapes::occlusion_shard shard;
+    test.check(
+      not eagine::shapes::read_occlusion_shard(partial, shard),
+      "truncated rejected");
+}
+//------------------------------------------------------------------------------
+auto occlusion_bent_normals(
+  eagine::shared_holder<eagine::shapes::generator> gen,
+  eagine::main_ctx& ctx) -> std::array<std::vector<float>, 2> {
+    using eagine::shapes::vertex_attrib_kind;
+    eagine::shapes::occlusion_options opts{64};
+    opts.seed = 5678U;
+    opts.bent_normals = true;
+    auto occl{eagine::shapes::occlude(std::move(gen), opts, ctx)};
+    const auto bent{occl->find_variant(vertex_attrib_kind::normal, "bent")};
+    std::array<std::vector<float>, 2> result;
+    if(bent) {
+        for(auto& values : result) {
+            values.resize(std::size_t(occl->value_count(bent)));
+        }
+        occl->attrib_values(
+          {vertex_attrib_kind::normal, 0}, eagine::cover(result[0]));
+        occl->attrib_values(bent, eagine::cover(result[1]));
+    }
+    return result;
+}
+//------------------------------------------------------------------------------
+void occlusion_bent_normal_length(auto& s) {
+    eagitest::case_ test{s, 5, "bent normals"};
+
+    const auto [normals, bent] =
+      occlusion_bent_normals(occlusion_test_shape(), s.context());
+    test.ensure(not bent.empty(), "has bent normals");
+    test.ensure(bent.size() == normals.size(), "value count");
+    for(std::size_t i = 0; i < bent.size(); i += 3) {
+        const auto l{std::sqrt(
+          bent[i + 0] * bent[i + 0] + bent[i + 1] * bent[i + 1] +
+          bent[i + 2] * bent[i + 2])};
+        test.check(std::abs(l - 1.F) < 0.001F, "unit length");
+        const auto d{
+          bent[i + 0] * normals[i + 0] + bent[i + 1] * normals[i + 1] +
+          bent[i + 2] * normals[i + 2]};
+        test.check(d > -0.001F, "in the normal hemisphere");
+    }
+}
+//------------------------------------------------------------------------------
+void occlusion_bent_normal_fallback(auto& s) {
+    eagitest::case_ test{s, 6, "bent normal fallback"};
+    using eagine::shapes::vertex_attrib_kind;
+
+    // the sphere turned inside-out, all rays from its vertices are occluded
+    const auto [normals, bent] = occlusion_bent_normals(
+      eagine::shapes::scale(
+        eagine::shapes::unit_sphere(
+          vertex_attrib_kind::position | vertex_attrib_kind::normal, 6, 12),
+        {-1.F, -1.F, -1.F}),
+      s.context());
+    test.ensure(not bent.empty(), "has bent normals");
+    test.ensure(bent.size() == normals.size(), "value count");
+    std::size_t same{0U};
+    for(std::size_t i = 0; i < bent.size(); i += 3) {
+        const auto l{std::sqrt(
+          normals[i + 0] * normals[i + 0] + normals[i + 1] * normals[i + 1] +
+          normals[i + 2] * normals[i + 2])};
+        const auto d{
+          bent[i + 0] * normals[i + 0] + bent[i + 1] * normals[i + 1] +
+          bent[i + 2] * normals[i + 2]};
+        if(std::abs(d - l) < 0.001F) {
+            ++same;
+        }
+    }
+    // a few rays may slip between the triangles at the vertices
+    test.check(same * 10U >= (bent.size() / 3U) * 9U, "geometric normals");
+}
+//------------------------------------------------------------------------------
+void occlusion_instrumentation(auto& s) {
+    eagitest::case_ test{s, 7, "instrumentation"};
+    using eagine::shapes::vertex_attrib_kind;
+
+    eagine::shapes::occlusion_options opts{32};
+    opts.seed = 4567U;
+    opts.instrumentation =
+      std::make_shared<eagine::shapes::generator_instrumentation>();
+    auto gen{occlusion_test_shape()};
+    const auto vertex_count{gen->vertex_count()};
+    const auto values{occlusion_values(std::move(gen), opts, s.context())};
+    test.ensure(not values.empty(), "has values");
+
+    // the rays traced by the bake do not go through the generators
+    const auto report{opts.instrumentation->report()};
+    test.ensure(report.size() == 2, "node count");
+    test.check(report[0].name == "cache", "cache name");
+    test.check(report[1].name == "occlusion", "occlusion name");
+    test.check(report[0].attrib_values.call_count >= 2, "fetched inputs");
+    test.check(report[1].ray_intersections.call_count == 1, "traced once");
+    test.check(
+      report[1].ray_intersections.ray_count == vertex_count * opts.samples,
+      "ray count");
+    test.check(
+      report[1].ray_intersections.duration.count() > 0, "tracing time");
+}
+//------------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------------
+auto test_main(eagine::test_ctx& ctx) -> int {
+    eagitest::ctx_suite test{ctx, "occlusion", 7};
+    test.once(occlusion_sampling_strategies);
+    test.once(occlusion_early_termination);
+    test.once(occlusion_reproducible);
+    test.once(occlusion_shards);
+    test.once(occlusion_bent_normal_length);
+    test.once(occlusion_bent_normal_fallback);
+    test.once(occlusion_instrumentation);
+    return test.exit_code();
+}
+//------------------------------------------------------------------------------
+auto main(int argc, const char** argv) -> int {
+    return eagine::test_main_impl(argc, argv, test_main);
+}
+//------------------------------------------------------------------------------
+#include <eagine/testing/unit_end_ctx.hpp>
@@ -0,0 +1,810 @@
+/// @file
+///
+/// Copyright Matus Chochlik.
+/// Distributed under the Boost Software License, Version 1.0.
+/// See accompanying file LICENSE_1_0.txt or copy at
+/// https://www.boost.org/LICENSE_1_0.txt
+///
+module;
+
+#include <cassert>
+#if __has_include(<sys/mman.h>) && __has_include(<sys/stat.h>) && \
+  __has_include(<fcntl.h>) && __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define EAGINE_SHAPES_USE_MMAP 1
+#else
+#define EAGINE_SHAPES_USE_MMAP 0
+#endif
+
+module eagine.shapes;
+
+import std;
+import eagine.core;
+
+namespace eagine::shapes {
+//------------------------------------------------------------------------------
+// The file starts with a magic, the format and data versions, the size of
+// the key, the number of data sections and the key itself (padded to 8 bytes).
+// Then follows the table of sections and the section data, each aligned
+// to 16 bytes. The files are meant only as a local cache and use the native
+// byte order. Files with other versions are ignored and re-written.
+//------------------------------------------------------------------------------
+static constexpr const std::array<char, 8> persisted_shape_magic{
+  {'E', 'A', 'G', 'S', 'H', 'P', 'C', '1'}};
+// bump when the layout of the file or of the sections changes
+static constexpr const std::uint32_t persisted_shape_format_version{1U};
+// bump when the generators produce different data for the same key
+static constexpr const std::uint32_t persisted_shape_data_version{1U};
+static constexpr const std::size_t persisted_shape_alignment{16U};
+//------------------------------------------------------------------------------
+// The temporary file name must be unique across processes and threads
+// that can store the same shape at the same time.
+static auto persisted_temp_suffix() -> std::string {
+#if EAGINE_SHAPES_USE_MMAP
+    const auto process_id{std::uint64_t(::getpid())};
+#else
+    const auto process_id{std::uint64_t(std::random_device{}())};
+#endif
+    return std::format(
+      ".{}.{:x}.tmp",
+      process_id,
+      std::hash<std::thread::id>{}(std::this_thread::get_id()));
+}
+//------------------------------------------------------------------------------
+enum class persisted_section_kind : std::uint32_t {
+    attrib_values,
+    indices,
+    instructions,
+    // bounding sphere center and radius followed by the box min and max
+    bounds
+};
+static constexpr const std::size_t persisted_bounds_count{10U};
+//------------------------------------------------------------------------------
+struct persisted_section {
+    persisted_section_kind kind{persisted_section_kind::attrib_values};
+    // vertex attribute kind bit for attribute values, zero otherwise
+    std::uint32_t attrib{0U};
+    // attribute variant index or drawing variant
+    std::int64_t variant{0};
+    std::uint64_t offset{0U};
+    std::uint64_t size{0U};
+    // attrib_data_type of attribute values
+    std::uint32_t data_type{0U};
+    std::uint32_t reserved{0U};
+};
+//------------------------------------------------------------------------------
+static auto persisted_key_hash(const string_view key) noexcept
+  -> std::uint64_t {
+    // FNV-1a
+    std::uint64_t hash{0xCBF29CE484222325ULL};
+    for(const char c : key) {
+        hash ^= std::uint64_t(static_cast<unsigned char>(c));
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+//------------------------------------------------------------------------------
+static auto persisted_align(
+  const std::uint64_t offset,
+  const std::uint64_t alignment = persisted_shape_alignment) noexcept
+  -> std::uint64_t {
+    return ((offset + alignment - 1U) / alignment) * alignment;
+}
+//------------------------------------------------------------------------------
+static auto persisted_section_table_offset(const span_size_t key_size) noexcept
+  -> std::uint64_t {
+    return persisted_align(
+      persisted_shape_magic.size() + 2U * sizeof(std::uint32_t) +
+        2U * sizeof(std::uint64_t) + std::uint64_t(key_size),
+      8U);
+}
+//------------------------------------------------------------------------------
+// persisted_shape_file
+//------------------------------------------------------------------------------
+class persisted_shape_file {
+public:
+    persisted_shape_file() noexcept = default;
+    persisted_shape_file(persisted_shape_file&&) = delete;
+    persisted_shape_file(const persisted_shape_file&) = delete;
+    auto operator=(persisted_shape_file&&) = delete;
+    auto operator=(const persisted_shape_file&) = delete;
+    ~persisted_shape_file() noexcept;
+
+    auto open(const std::filesystem::path&, const string_view key) -> bool;
+
+    auto find(
+      const persisted_section_kind,
+      const std::uint32_t attrib,
+      const span_size_t variant) const noexcept -> const persisted_section*;
+
+    template <typename T>
+    auto data_of(const persisted_section& section) const noexcept
+      -> span<const T> {
+        assert(section.offset + section.size <= _size);
+        return {
+          reinterpret_cast<const T*>(_data + section.offset),
+          span_size(section.size / sizeof(T))};
+    }
+
+private:
+    auto _map(const std::filesystem::path&) -> bool;
+    auto _parse(const string_view key) -> bool;
+
+    const unsigned char* _data{nullptr};
+    std::size_t _size{0U};
+    bool _mapped{false};
+    std::vector<unsigned char> _buffer;
+    std::vector<persisted_section> _sections;
+};
+//------------------------------------------------------------------------------
+persisted_shape_file::~persisted_shape_file() noexcept {
+#if EAGINE_SHAPES_USE_MMAP
+    if(_mapped) {
+        ::munmap(const_cast<unsigned char*>(_data), _size);
+    }
+#endif
+}
+//------------------------------------------------------------------------------
+auto persisted_shape_file::_map(const std::filesystem::path& path) -> bool {
+#if EAGINE_SHAPES_USE_MMAP
+    const int fd{::open(path.c_str(), O_RDONLY)};
+    if(fd < 0) {
+        return false;
+    }
+    struct ::stat info {};
+    if((::fstat(fd, &info) == 0) and (info.st_size > 0)) {
+        const auto size{std::size_t(info.st_size)};
+        void* addr{::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)};
+        if(addr != MAP_FAILED) {
+            _data = static_cast<const unsigned char*>(addr);
+            _size = size;
+            _mapped = true;
+        }
+    }
+    ::close(fd);
+    return _mapped;
+#else
+    std::ifstream input{path, std::ios::binary};
+    if(not input) {
+        return false;
+    }
+    _buffer.assign(
+      std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{});
+    _data = _buffer.data();
+    _size = _buffer.size();
+    return not _buffer.empty();
+#endif
+}
+//------------------------------------------------------------------------------
+auto persisted_shape_file::_parse(const string_view key) -> bool {
+    std::size_t pos{0U};
+    const auto read{[&](void* dest, const std::size_t size) {
+        if(pos + size > _size) {
+            return false;
+        }
+        std::memcpy(dest, _data + pos, size);
+        pos += size;
+        return true;
+    }};
+
+    std::array<char, 8> magic{};
+    std::uint32_t format_version{0U};
+    std::uint32_t data_version{0U};
+    std::uint64_t key_size{0U};
+    std::uint64_t section_count{0U};
+    if(not read(magic.data(), magic.size())) {
+        return false;
+    }
+    if(magic != persisted_shape_magic) {
+        return false;
+    }
+    if(not read(&format_version, sizeof(format_version))) {
+        return false;
+    }
+    if(not read(&data_version, sizeof(data_version))) {
+        return false;
+    }
+    if(
+      (format_version != persisted_shape_format_version) or
+      (data_version != persisted_shape_data_version)) {
+        return false;
+    }
+    if(not read(&key_size, sizeof(key_size))) {
+        return false;
+    }
+    if(not read(&section_count, sizeof(section_count))) {
+        return false;
+    }
+    if((key_size != std::uint64_t(key.size())) or (pos + key_size > _size)) {
+        return false;
+    }
+    if(std::memcmp(_data + pos, key.data(), key_size) != 0) {
+        return false;
+    }
+    pos = std_size(persisted_section_table_offset(key.size()));
+    if(
+      (pos > _size) or
+      (section_count > (_size - pos) / sizeof(persisted_section))) {
+        return false;
+    }
+    _sections.resize(std_size(section_count));
+    for(auto& section : _sections) {
+        if(not read(&section, sizeof(section))) {
+            return false;
+        }
+        if(
+          (section.offset % persisted_shape_alignment != 0U) or
+          (section.offset > _size) or (section.size > _size - section.offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+//------------------------------------------------------------------------------
+auto persisted_shape_file::open(
+  const std::filesystem::path& path,
+  const string_view key) -> bool {
+    if(_map(path)) {
+        if(_parse(key)) {
+            return true;
+        }
+        _sections.clear();
+    }
+    return false;
+}
+//------------------------------------------------------------------------------
+auto persisted_shape_file::find(
+  const persisted_section_kind kind,
+  const std::uint32_t attrib,
+  const span_size_t variant) const noexcept -> const persisted_section* {
+    for(const auto& section : _sections) {
+        if(
+          (section.kind == kind) and (section.attrib == attrib) and
+          (section.variant == variant)) {
+            return &section;
+        }
+    }
+    return nullptr;
+}
+//------------------------------------------------------------------------------
+// persisted_gen
+//------------------------------------------------------------------------------
+class persisted_gen
+  : public main_ctx_object
+  , public delegated_gen {
+public:
+    persisted_gen(
+      shared_holder<generator> gen,
+      const string_view key,
+      const std::filesystem::path& directory,
+      main_ctx_parent parent);
+
+    void attrib_values(const vertex_attrib_variant, span<byte>) final;
+    void attrib_values(const vertex_attrib_variant, span<std::int16_t>) final;
+    void attrib_values(const vertex_attrib_variant, span<std::uint16_t>) final;
+    void attrib_values(const vertex_attrib_variant, span<std::int32_t>) final;
+    void attrib_values(const vertex_attrib_variant, span<std::uint32_t>) final;
+    void attrib_values(const vertex_attrib_variant, span<float>) final;
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<byte>) -> shared_data_view<byte> final {
+        return _values_view<byte>(vav);
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::int16_t>)
+      -> shared_data_view<std::int16_t> final {
+        return _values_view<std::int16_t>(vav);
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::uint16_t>)
+      -> shared_data_view<std::uint16_t> final {
+        return _values_view<std::uint16_t>(vav);
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::int32_t>)
+      -> shared_data_view<std::int32_t> final {
+        return _values_view<std::int32_t>(vav);
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::uint32_t>)
+      -> shared_data_view<std::uint32_t> final {
+        return _values_view<std::uint32_t>(vav);
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<float>) -> shared_data_view<float> final {
+        return _values_view<float>(vav);
+    }
+
+    void indices(const drawing_variant, span<std::uint8_t> dest) final;
+    void indices(const drawing_variant, span<std::uint16_t> dest) final;
+    void indices(const drawing_variant, span<std::uint32_t> dest) final;
+
+    using delegated_gen::indices_view;
+    auto indices_view(
+      const drawing_variant var,
+      std::type_identity<std::uint32_t>)
+      -> shared_data_view<std::uint32_t> final;
+
+    void instructions(const drawing_variant, span<draw_operation> dest) final;
+    auto instructions_view(const drawing_variant)
+      -> shared_data_view<draw_operation> final;
+
+    auto bounding_sphere() -> math::sphere<float> final;
+    auto bounding_box() -> shape_bounding_box final;
+
+    void ray_intersections(
+      generator&,
+      const drawing_variant,
+      const span<const math::line<float>> rays,
+      span<optionally_valid<float>> intersections) final;
+
+private:
+    auto _store(const string_view key, const std::filesystem::path&) -> bool;
+
+    auto _stored_section(
+      const persisted_section_kind,
+      const std::uint32_t attrib,
+      const span_size_t variant,
+      const attrib_data_type,
+      const std::uint64_t size) const noexcept -> const persisted_section*;
+
+    template <typename T>
+    auto _stored_values(const vertex_attrib_variant)
+      -> optionally_valid<span<const T>>;
+
+    template <typename T>
+    auto _values_view(const vertex_attrib_variant) -> shared_data_view<T>;
+
+    template <typename T>
+    void _get_values(const vertex_attrib_variant, span<T>);
+
+    template <typename T>
+    void _get_indices(const drawing_variant, span<T>);
+
+    auto _stored_bounds() const noexcept -> span<const float>;
+
+    struct _bvh_slot {
+        std::once_flag once;
+        triangle_bvh bvh;
+    };
+
+    std::shared_ptr<persisted_shape_file> _file;
+    // the hierarchies are built from the persisted data, if available
+    const std::unique_ptr<_bvh_slot[]> _bvhs;
+};
+//------------------------------------------------------------------------------
+auto persistent_cache(
+  shared_holder<generator> gen,
+  const string_view key,
+  const std::filesystem::path& directory,
+  main_ctx_parent parent) -> shared_holder<generator> {
+    return {hold<persisted_gen>, std::move(gen), key, directory, parent};
+}
+//------------------------------------------------------------------------------
+persisted_gen::persisted_gen(
+  shared_holder<generator> gen,
+  const string_view key,
+  const std::filesystem::path& directory,
+  main_ctx_parent parent)
+  : main_ctx_object{"PrstShpGen", parent}
+  , delegated_gen{cache(std::move(gen), this->as_parent())}
+  , _bvhs{std::make_unique<_bvh_slot[]>(std_size(draw_variant_count()))} {
+    const auto path{
+      directory / std::format("{:016x}.eagshape", persisted_key_hash(key))};
+
+    auto file{std::make_shared<persisted_shape_file>()};
+    if(file->open(path, key)) {
+        log_debug("using persisted shape data")
+          .arg("key", key)
+          .arg("path", path.string());
+        _file = std::move(file);
+        return;
+    }
+    if(_store(key, path)) {
+        file = std::make_shared<persisted_shape_file>();
+        if(file->open(path, key)) {
+            _file = std::move(file);
+            return;
+        }
+    }
+    log_warning("failed to persist shape data, using in-memory cache")
+      .arg("key", key)
+      .arg("path", path.string());
+}
+//------------------------------------------------------------------------------
+auto persisted_gen::_store(
+  const string_view key,
+  const std::filesystem::path& path) -> bool {
+    auto& gen = *base_generator();
+    std::vector<persisted_section> sections;
+    std::vector<shared_data_view<byte>> blocks;
+
+    const auto add_section{[&](persisted_section section, auto values) {
+        using T = std::remove_cvref_t<decltype(values[0])>;
+        section.size = std::uint64_t(values.size()) * sizeof(T);
+        sections.push_back(section);
+        const span<const T> elements{values.values()};
+        blocks.emplace_back(
+          std::make_shared<decltype(values)>(std::move(values)),
+          span<const byte>{
+            reinterpret_cast<const byte*>(elements.data()),
+            span_size(section.size)});
+    }};
+
+    const auto add_values{[&](vertex_attrib_variant vav, auto tid) {
+        using T = typename decltype(tid)::type;
+        persisted_section section{};
+        section.kind = persisted_section_kind::attrib_values;
+        section.attrib = std::uint32_t(vav.attribute());
+        section.variant = vav.index();
+        section.data_type = std::uint32_t(attrib_data_type_of<T>());
+        add_section(section, shared_attrib_values<T>(gen, vav));
+    }};
+
+    for(const auto& info : enumerators<vertex_attrib_kind>()) {
+        if(not gen.has(info.enumerator)) {
+            continue;
+        }
+        const auto attrib{info.enumerator};
+        for(const auto v : integer_range(gen.attribute_variants(attrib))) {
+            const vertex_attrib_variant vav{attrib, v};
+            switch(gen.attrib_type(vav)) {
+                case attrib_data_type::ubyte:
+                    add_values(vav, std::type_identity<byte>{});
+                    break;
+                case attrib_data_type::int_16:
+                    add_values(vav, std::type_identity<std::int16_t>{});
+                    break;
+                case attrib_data_type::int_32:
+                    add_values(vav, std::type_identity<std::int32_t>{});
+                    break;
+                case attrib_data_type::uint_16:
+                    add_values(vav, std::type_identity<std::uint16_t>{});
+                    break;
+                case attrib_data_type::uint_32:
+                    add_values(vav, std::type_identity<std::uint32_t>{});
+                    break;
+                case attrib_data_type::float_:
+                    add_values(vav, std::type_identity<float>{});
+                    break;
+                case attrib_data_type::none:
+                    break;
+            }
+        }
+    }
+
+    for(const auto d : integer_range(gen.draw_variant_count())) {
+        const auto var{gen.draw_variant(d)};
+        persisted_section section{};
+        section.variant = var;
+        if(gen.index_type(var) != index_data_type::none) {
+            section.kind = persisted_section_kind::indices;
+            section.data_type = std::uint32_t(attrib_data_type::uint_32);
+            add_section(section, shared_indices<std::uint32_t>(gen, var));
+        }
+        section.kind = persisted_section_kind::instructions;
+        section.data_type = std::uint32_t(attrib_data_type::none);
+        add_section(section, shared_instructions(gen, var));
+    }
+
+    // the bounds are stored so that they are not computed from scratch
+    // by shapes which have to scan the positions to get them
+    const auto bs{gen.bounding_sphere()};
+    const auto bb{gen.bounding_box()};
+    const auto bounds{std::make_shared<std::vector<float>>(
+      std::initializer_list<float>{
+        bs.center().x(),
+        bs.center().y(),
+        bs.center().z(),
+        bs.radius(),
+        bb.min[0],
+        bb.min[1],
+        bb.min[2],
+        bb.max[0],
+        bb.max[1],
+        bb.max[2]})};
+    assert(bounds->size() == persisted_bounds_count);
+    persisted_section bounds_section{};
+    bounds_section.kind = persisted_section_kind::bounds;
+    bounds_section.data_type = std::uint32_t(attrib_data_type::float_);
+    const span<const float> bounds_view{view(*bounds)};
+    add_section(bounds_section, shared_data_view<float>{bounds, bounds_view});
+
+    const auto table_offset{persisted_section_table_offset(key.size())};
+    std::uint64_t offset{persisted_align(
+      table_offset + sections.size() * sizeof(persisted_section))};
+    for(auto& section : sections) {
+        section.offset = offset;
+        offset = persisted_align(offset + section.size);
+    }
+
+    // the file is written under a temporary name and then renamed,
+    // so that concurrent readers never see partially written data
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    auto temp_path{path};
+    temp_path += persisted_temp_suffix();
+    {
+        std::ofstream output{temp_path, std::ios::binary | std::ios::trunc};
+        if(not output) {
+            return false;
+        }
+        std::uint64_t written{0U};
+        const auto write{[&](const void* data, const std::size_t size) {
+            output.write(static_cast<const char*>(data), std::streamsize(size));
+            written += size;
+        }};
+        const auto pad_to{[&](const std::uint64_t position) {
+            const std::array<char, persisted_shape_alignment> zeros{};
+            assert(written <= position);
+            assert(position - written <= zeros.size());
+            write(zeros.data(), std_size(position - written));
+        }};
+        const std::uint64_t key_size{key.size()};
+        const std::uint64_t section_count{sections.size()};
+        write(persisted_shape_magic.data(), persisted_shape_magic.size());
+        write(
+          &persisted_shape_format_version,
+          sizeof(persisted_shape_format_version));
+        write(
+          &persisted_shape_data_version, sizeof(persisted_shape_data_version));
+        write(&key_size, sizeof(key_size));
+        write(&section_count, sizeof(section_count));
+        write(key.data(), std_size(key.size()));
+        pad_to(table_offset);
+        write(sections.data(), sections.size() * sizeof(persisted_section));
+        for(const auto i : index_range(sections)) {
+            pad_to(sections[i].offset);
+            const auto block{blocks[i].values()};
+            write(block.data(), std_size(block.size()));
+        }
+        if(not output) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, path, error);
+    if(error) {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    log_info("persisted shape data")
+      .arg("key", key)
+      .arg("path", path.string())
+      .arg("sections", sections.size())
+      .arg("size", offset);
+    return true;
+}
+//------------------------------------------------------------------------------
+auto persisted_gen::_stored_section(
+  const persisted_section_kind kind,
+  const std::uint32_t attrib,
+  const span_size_t variant,
+  const attrib_data_type data_type,
+  const std::uint64_t size) const noexcept -> const persisted_section* {
+    if(_file) {
+        const auto section{_file->find(kind, attrib, variant)};
+        if(section and (section->data_type == std::uint32_t(data_type))) {
+            // the sections are used only if they match the generator
+            if(section->size == size) {
+                return section;
+            }
+            log_warning("persisted shape data section size mismatch")
+              .arg("kind", std::uint32_t(kind))
+              .arg("variant", variant)
+              .arg("expected", size)
+              .arg("size", section->size);
+        }
+    }
+    return nullptr;
+}
+//------------------------------------------------------------------------------
+template <typename T>
+auto persisted_gen::_stored_values(const vertex_attrib_variant vav)
+  -> optionally_valid<span<const T>> {
+    if(const auto section{_stored_section(
+         persisted_section_kind::attrib_values,
+         std::uint32_t(vav.attribute()),
+         vav.index(),
+         attrib_data_type_of<T>(),
+         std::uint64_t(value_count(vav)) * sizeof(T))}) {
+        return {_file->data_of<T>(*section), true};
+    }
+    return {};
+}
+//------------------------------------------------------------------------------
+template <typename T>
+auto persisted_gen::_values_view(const vertex_attrib_variant vav)
+  -> shared_data_view<T> {
+    if(const auto stored{_stored_values<T>(vav)}) {
+        return {_file, *stored};
+    }
+    return {};
+}
+//------------------------------------------------------------------------------
+template <typename T>
+void persisted_gen::_get_values(
+  const vertex_attrib_variant vav,
+  span<T> dest) {
+    if(const auto stored{_stored_values<T>(vav)}) {
+        copy(*stored, dest);
+    } else {
+        delegated_gen::attrib_values(vav, dest);
+    }
+}
+//------------------------------------------------------------------------------
+void persisted_gen::attrib_values(
+  const vertex_attrib_variant vav,
+  span<byte> dest) {
+    _get_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+void persisted_gen::attrib_values(
+  const vertex_attrib_variant vav,
+  span<std::int16_t> dest) {
+    _get_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+void persisted_gen::attrib_values(
+  const vertex_attrib_variant vav,
+  span<std::uint16_t> dest) {
+    _get_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+void persisted_gen::attrib_values(
+  const vertex_attrib_variant vav,
+  span<std::int32_t> dest) {
+    _get_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+void persisted_gen::attrib_values(
+  const vertex_attrib_variant vav,
+  span<std::uint32_t> dest) {
+    _get_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+void persisted_gen::attrib_values(
+  const vertex_attrib_variant vav,
+  span<float> dest) {
+    _get_values(vav, dest);
+}
+//------------------------------------------------------------------------------
+template <typename T>
+void persisted_gen::_get_indices(const drawing_variant var, span<T> dest) {
+    if(const auto section{_stored_section(
+         persisted_section_kind::indices,
+         0U,
+         var,
+         attrib_data_type::uint_32,
+         std::uint64_t(index_count(var)) * sizeof(std::uint32_t))}) {
+        const auto stored{_file->data_of<std::uint32_t>(*section)};
+        assert(dest.size() >= stored.size());
+        for(const auto i : index_range(stored)) {
+            dest[i] = limit_cast<T>(stored[i]);
+        }
+        return;
+    }
+    delegated_gen::indices(var, dest);
+}
+//------------------------------------------------------------------------------
+void persisted_gen::indices(
+  const drawing_variant var,
+  span<std::uint8_t> dest) {
+    _get_indices(var, dest);
+}
+//------------------------------------------------------------------------------
+void persisted_gen::indices(
+  const drawing_variant var,
+  span<std::uint16_t> dest) {
+    _get_indices(var, dest);
+}
+//------------------------------------------------------------------------------
+void persisted_gen::indices(
+  const drawing_variant var,
+  span<std::uint32_t> dest) {
+    _get_indices(var, dest);
+}
+//------------------------------------------------------------------------------
+auto persisted_gen::indices_view(
+  const drawing_variant var,
+  std::type_identity<std::uint32_t>) -> shared_data_view<std::uint32_t> {
+    if(const auto section{_stored_section(
+         persisted_section_kind::indices,
+         0U,
+         var,
+         attrib_data_type::uint_32,
+         std::uint64_t(index_count(var)) * sizeof(std::uint32_t))}) {
+        return {_file, _file->data_of<std::uint32_t>(*section)};
+    }
+    return {};
+}
+//------------------------------------------------------------------------------
+void persisted_gen::instructions(
+  const drawing_variant var,
+  span<draw_operation> dest) {
+    if(const auto stored{instructions_view(var)}) {
+        copy(stored.values(), dest);
+    } else {
+        delegated_gen::instructions(var, dest);
+    }
+}
+//------------------------------------------------------------------------------
+auto persisted_gen::instructions_view(const drawing_variant var)
+  -> shared_data_view<draw_operation> {
+    if(const auto section{_stored_section(
+         persisted_section_kind::instructions,
+         0U,
+         var,
+         attrib_data_type::none,
+         std::uint64_t(operation_count(var)) * sizeof(draw_operation))}) {
+        return {_file, _file->data_of<draw_operation>(*section)};
+    }
+    return {};
+}
+//------------------------------------------------------------------------------
+auto persisted_gen::_stored_bounds() const noexcept -> span<const float> {
+    if(const auto section{_stored_section(
+         persisted_section_kind::bounds,
+         0U,
+         0,
+         attrib_data_type::float_,
+         persisted_bounds_count * sizeof(float))}) {
+        return _file->data_of<float>(*section);
+    }
+    return {};
+}
+//------------------------------------------------------------------------------
+auto persisted_gen::bounding_sphere() -> math::sphere<float> {
+    if(const auto b{_stored_bounds()}; not b.empty()) {
+        return {{b[0], b[1], b[2]}, b[3]};
+    }
+    return delegated_gen::bounding_sphere();
+}
+//------------------------------------------------------------------------------
+auto persisted_gen::bounding_box() -> shape_bounding_box {
+    if(const auto b{_stored_bounds()}; not b.empty()) {
+        return {{b[4], b[5], b[6]}, {b[7], b[8], b[9]}};
+    }
+    return delegated_gen::bounding_box();
+}
+//------------------------------------------------------------------------------
+void persisted_gen::ray_intersections(
+  generator& gen,
+  const drawing_variant var,
+  const span<const math::line<float>> rays,
+  span<optionally_valid<float>> intersections) {
+    if(
+      _file and (&gen == this) and (var >= 0) and
+      (var < draw_variant_count())) {
+        // the hierarchy is built from the persisted positions and indices,
+        // without regenerating the shape
+        auto& slot = _bvhs[std_size(var)];
+        std::call_once(slot.once, [&] {
+            slot.bvh = triangle_bvh{*this, var};
+            log_debug("built triangle hierarchy from persisted data")
+              .arg("variant", var)
+              .arg("triangles", slot.bvh.triangle_count());
+        });
+        slot.bvh.ray_intersections(rays, intersections);
+    } else {
+        // let the cache use its prepared triangle hierarchy
+        auto& base = *base_generator();
+        base.ray_intersections(
+          &gen == this ? base : gen, var, rays, intersections);
+    }
+}
+//------------------------------------------------------------------------------
+} // namespace eagine::shapes
@@ -59,6 +59,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
 private:
     using _base = generator_base;
 
@@ -359,5 +361,9 @@ auto unit_plane_gen::bounding_sphere() -> math::sphere<float> {
     return {{}, float(sqrt(2.F))};
 }
 //------------------------------------------------------------------------------
+auto unit_plane_gen::bounding_box() -> shape_bounding_box {
+    return {{-1.F, 0.F, -1.F}, {1.F, 0.F, 1.F}};
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
 
@@ -20,6 +20,17 @@ export [[nodiscard]] auto add_primitive_info(
   shared_holder<generator> gen,
   vertex_attrib_kinds attribs,
   main_ctx_parent parent) noexcept -> shared_holder<generator>;
+
+/// @brief Constructs instances of primitive_info modifier.
+/// @ingroup shapes
+/// @see topology
+///
+/// The shape topology is persisted in and reused from the specified directory.
+export [[nodiscard]] auto add_primitive_info(
+  shared_holder<generator> gen,
+  vertex_attrib_kinds attribs,
+  const std::filesystem::path& topology_dir,
+  main_ctx_parent parent) noexcept -> shared_holder<generator>;
 //------------------------------------------------------------------------------
 } // namespace eagine::shapes
 
@@ -31,6 +31,7 @@ public:
     primitive_info_gen(
       shared_holder<generator> gen,
       vertex_attrib_kinds attribs,
+      std::filesystem::path topology_dir,
       main_ctx_parent parent) noexcept;
 
     auto enable(const generator_capability cap, const bool value) noexcept
@@ -54,6 +55,7 @@ private:
     template <typename T>
     void _indices(const drawing_variant, span<T> dest) noexcept;
 
+    std::filesystem::path _topology_dir;
     std::map<drawing_variant, topology> _topologies;
     vertex_attrib_kinds _attribs;
 };
@@ -62,7 +64,16 @@ auto add_primitive_info(
   shared_holder<generator> gen,
   vertex_attrib_kinds attribs,
   main_ctx_parent parent) noexcept -> shared_holder<generator> {
-    return {hold<primitive_info_gen>, std::move(gen), attribs, parent};
+    return {hold<primitive_info_gen>, std::move(gen), attribs, "", parent};
+}
+//------------------------------------------------------------------------------
+auto add_primitive_info(
+  shared_holder<generator> gen,
+  vertex_attrib_kinds attribs,
+  const std::filesystem::path& topology_dir,
+  main_ctx_parent parent) noexcept -> shared_holder<generator> {
+    return {
+      hold<primitive_info_gen>, std::move(gen), attribs, topology_dir, parent};
 }
 //------------------------------------------------------------------------------
 auto primitive_info_gen::_topology(const drawing_variant var) noexcept
@@ -72,9 +83,20 @@ auto primitive_info_gen::_topology(const drawing_variant var) noexcept
         topology_options opts;
         opts.features = topology_feature_bit::triangle_area |
                         topology_feature_bit::edge_length;
-        found.emplace(
-          var,
-          topology{delegated_gen::base_generator(), opts, this->as_parent()});
+        if(_topology_dir.empty()) {
+            found.emplace(
+              var,
+              topology{
+                delegated_gen::base_generator(), opts, this->as_parent()});
+        } else {
+            found.emplace(
+              var,
+              topology{
+                delegated_gen::base_generator(),
+                opts,
+                _topology_dir,
+                this->as_parent()});
+        }
     }
     return *found;
 }
@@ -82,9 +104,11 @@ auto primitive_info_gen::_topology(const drawing_variant var) noexcept
 primitive_info_gen::primitive_info_gen(
   shared_holder<generator> gen,
   vertex_attrib_kinds attribs,
+  std::filesystem::path topology_dir,
   main_ctx_parent parent) noexcept
   : main_ctx_object{"PrimInfGen", parent}
   , delegated_gen{cache(std::move(gen), this->as_parent())}
+  , _topology_dir{std::move(topology_dir)}
   , _attribs{attribs} {
     delegated_gen::_add(_attribs);
 }
@@ -0,0 +1,156 @@
+/// @file
+///
+/// Copyright Matus Chochlik.
+/// Distributed under the Boost Software License, Version 1.0.
+/// See accompanying file LICENSE_1_0.txt or copy at
+/// https://www.boost.org/LICENSE_1_0.txt
+///
+export module eagine.shapes:ray_query;
+
+import std;
+import eagine.core.types;
+import eagine.core.memory;
+import eagine.core.utility;
+import eagine.core.valid_if;
+import eagine.core.math;
+import :generator;
+
+namespace eagine::shapes {
+//------------------------------------------------------------------------------
+/// @brief Bounding volume hierarchy over the triangles of a generated shape.
+/// @ingroup shapes
+/// @see generator::ray_intersections
+///
+/// The hierarchy is built with the surface area heuristic evaluated on binned
+/// triangle centroids. Once built it is immutable and can be queried
+/// concurrently from multiple threads.
+export class triangle_bvh {
+public:
+    /// @brief Default constructor, constructs an empty hierarchy.
+    triangle_bvh() noexcept = default;
+
+    /// @brief Builds the hierarchy over triangles in the specified drawing variant.
+    triangle_bvh(generator& gen, const drawing_variant var);
+
+    /// @brief Indicates if the hierarchy contains no triangles.
+    auto is_empty() const noexcept -> bool {
+        return _faces.v0.front().empty();
+    }
+
+    /// @brief Returns the number of triangles in the hierarchy.
+    auto triangle_count() const noexcept -> span_size_t {
+        return span_size(_faces.v0.front().size());
+    }
+
+    /// @brief Returns the number of nodes in the hierarchy.
+    auto node_count() const noexcept -> span_size_t {
+        return span_size(_nodes.size());
+    }
+
+    /// @brief Returns the number of bytes used by the hierarchy data.
+    auto byte_size() const noexcept -> span_size_t {
+        // v0, e1, e2 and the normal, each with three coordinates
+        return span_size(
+          _faces.v0.front().size() * 4U * 3U * sizeof(float) +
+          _nodes.size() * sizeof(node));
+    }
+
+    /// @brief Finds the nearest front-facing intersections with the specified rays.
+    /// @pre intersections.size() >= rays.size()
+    ///
+    /// Valid values already present in intersections are only overwritten
+    /// by nearer intersections.
+    void ray_intersections(
+      const span<const math::line<float>> rays,
+      span<optionally_valid<float>> intersections) const noexcept;
+
+private:
+    struct face {
+        std::array<float, 9> coords{};
+        bool cw_face_winding{false};
+
+        auto triangle() const noexcept -> math::triangle<float>;
+    };
+
+    struct node {
+        std::array<float, 3> min{};
+        std::array<float, 3> max{};
+        // index of the first face for leafs or of the first child otherwise
+        // (the second child immediately follows the first one)
+        std::uint32_t offset{0U};
+        // number of faces for leafs or zero otherwise
+        std::uint32_t count{0U};
+    };
+
+    // triangle data in structure-of-arrays layout, ordered by leafs
+    struct face_data {
+        std::array<std::vector<float>, 3> v0;
+        std::array<std::vector<float>, 3> e1;
+        std::array<std::vector<float>, 3> e2;
+        // normal of the front face
+        std::array<std::vector<float>, 3> nml;
+    };
+
+    void _build(std::vector<face>);
+
+    auto _nearest_in_leaf(
+      const node&,
+      const std::array<float, 3>& orig,
+      const std::array<float, 3>& dir,
+      float limit) const noexcept -> float;
+
+    face_data _faces;
+    std::vector<node> _nodes;
+};
+//------------------------------------------------------------------------------
+/// @brief Prepared, thread-shareable context for batched ray queries on a shape.
+/// @ingroup shapes
+/// @see triangle_bvh
+///
+/// The shape positions, draw instructions and indices are fetched only once,
+/// when the context is constructed. Copies of the context share the prepared
+/// data and all queries are const, so a single context can be used by any
+/// number of threads for the whole lifetime of a computation.
+export class ray_query_context {
+public:
+    /// @brief Default constructor, constructs an empty context.
+    ray_query_context() noexcept = default;
+
+    /// @brief Prepares the triangles of the specified drawing variant of gen.
+    ray_query_context(generator& gen, const drawing_variant var);
+
+    /// @brief Indicates if the context contains no triangles.
+    auto is_empty() const noexcept -> bool {
+        return not _bvh or _bvh->is_empty();
+    }
+
+    /// @brief Returns the number of triangles prepared for the queries.
+    auto triangle_count() const noexcept -> span_size_t {
+        return _bvh ? _bvh->triangle_count() : 0;
+    }
+
+    /// @brief Finds the nearest front-facing intersections with the specified rays.
+    /// @pre intersections.size() >= rays.size()
+    /// @see generator::ray_intersections
+    void ray_intersections(
+      const span<const math::line<float>> rays,
+      span<optionally_valid<float>> intersections) const noexcept {
+        if(_bvh) {
+            _bvh->ray_intersections(rays, intersections);
+        }
+    }
+
+    /// @brief Finds the nearest front-facing intersection with the specified ray.
+    auto nearest_intersection(const math::line<float>& ray) const noexcept
+      -> optionally_valid<float> {
+        optionally_valid<float> result{};
+        ray_intersections(view_one(ray), cover_one(result));
+        return result;
+    }
+
+private:
+    std::shared_ptr<const triangle_bvh> _bvh;
+};
+//------------------------------------------------------------------------------
+} // namespace eagine::shapes
+
@@ -0,0 +1,415 @@
+/// @file
+///
+/// Copyright Matus Chochlik.
+/// Distributed under the Boost Software License, Version 1.0.
+/// See accompanying file LICENSE_1_0.txt or copy at
+/// https://www.boost.org/LICENSE_1_0.txt
+///
+module;
+
+#include <cassert>
+
+module eagine.shapes;
+
+import std;
+import eagine.core;
+
+namespace eagine::shapes {
+//------------------------------------------------------------------------------
+struct bvh_bounds {
+    std::array<float, 3> min{
+      std::numeric_limits<float>::max(),
+      std::numeric_limits<float>::max(),
+      std::numeric_limits<float>::max()};
+
+    std::array<float, 3> max{
+      std::numeric_limits<float>::lowest(),
+      std::numeric_limits<float>::lowest(),
+      std::numeric_limits<float>::lowest()};
+
+    void add(const std::array<float, 3>& p) noexcept {
+        for(const auto c : integer_range(std_size(3))) {
+            min[c] = math::minimum(min[c], p[c]);
+            max[c] = math::maximum(max[c], p[c]);
+        }
+    }
+
+    void merge(const bvh_bounds& that) noexcept {
+        add(that.min);
+        add(that.max);
+    }
+
+    auto extent(const std::size_t c) const noexcept -> float {
+        return max[c] - min[c];
+    }
+
+    auto area() const noexcept -> float {
+        if(max[0] < min[0]) {
+            return 0.F;
+        }
+        const auto x = extent(0);
+        const auto y = extent(1);
+        const auto z = extent(2);
+        return 2.F * (x * y + y * z + z * x);
+    }
+};
+//------------------------------------------------------------------------------
+static auto bvh_bin_of(
+  const float value,
+  const float min,
+  const float extent,
+  const std::size_t bin_count) noexcept -> std::size_t {
+    const auto b = std_size(float(bin_count) * (value - min) / extent);
+    return math::minimum(b, bin_count - 1U);
+}
+//------------------------------------------------------------------------------
+auto triangle_bvh::face::triangle() const noexcept -> math::triangle<float> {
+    return math::triangle<float>{
+      {coords[0], coords[1], coords[2]},
+      {coords[3], coords[4], coords[5]},
+      {coords[6], coords[7], coords[8]}};
+}
+//------------------------------------------------------------------------------
+triangle_bvh::triangle_bvh(generator& gen, const drawing_variant var) {
+    const auto pvak = vertex_attrib_kind::position;
+    const auto vpv = gen.values_per_vertex(pvak);
+    if(vpv < 3) {
+        return;
+    }
+
+    const auto pos{shared_attrib_values<float>(gen, pvak)};
+
+    std::vector<face> faces;
+    const auto add_face{[&faces, &pos, vpv](const shape_face_info& info) {
+        face fce{};
+        for(const auto v : integer_range(std_size(3))) {
+            for(const auto c : integer_range(std_size(3))) {
+                fce.coords[v * 3 + c] =
+                  pos[std_size(info.indices[v] * vpv) + c];
+            }
+        }
+        fce.cw_face_winding = info.cw_face_winding;
+        faces.push_back(fce);
+    }};
+
+    gen.for_each_triangle(gen, var, {construct_from, add_face});
+    _build(std::move(faces));
+}
+//------------------------------------------------------------------------------
+void triangle_bvh::_build(std::vector<face> faces) {
+    if(faces.empty()) {
+        return;
+    }
+    static constexpr const std::size_t bin_count{12U};
+    static constexpr const std::uint32_t max_leaf_size{8U};
+    static constexpr const std::uint32_t max_depth{48U};
+
+    const auto fc = limit_cast<std::uint32_t>(faces.size());
+
+    std::vector<bvh_bounds> bounds(fc);
+    std::vector<std::array<float, 3>> centroids(fc);
+    std::vector<std::uint32_t> order(fc);
+    std::iota(order.begin(), order.end(), 0U);
+
+    for(const auto f : integer_range(faces.size())) {
+        const auto& coords = faces[f].coords;
+        for(const auto v : integer_range(std_size(3))) {
+            bounds[f].add(
+              {coords[v * 3 + 0], coords[v * 3 + 1], coords[v * 3 + 2]});
+        }
+        for(const auto c : integer_range(std_size(3))) {
+            centroids[f][c] = (bounds[f].min[c] + bounds[f].max[c]) * 0.5F;
+        }
+    }
+
+    struct build_task {
+        std::uint32_t node;
+        std::uint32_t first;
+        std::uint32_t count;
+        std::uint32_t depth;
+    };
+
+    _nodes.reserve(std_size(2U * fc));
+    _nodes.emplace_back();
+    std::vector<build_task> tasks{{0U, 0U, fc, 0U}};
+
+    while(not tasks.empty()) {
+        const auto task = tasks.back();
+        tasks.pop_back();
+
+        const auto begin = std::next(order.begin(), task.first);
+        const auto end = std::next(begin, task.count);
+
+        bvh_bounds node_bounds;
+        bvh_bounds centroid_bounds;
+        for(auto pos = begin; pos != end; ++pos) {
+            node_bounds.merge(bounds[*pos]);
+            centroid_bounds.add(centroids[*pos]);
+        }
+        _nodes[task.node].min = node_bounds.min;
+        _nodes[task.node].max = node_bounds.max;
+
+        const auto make_leaf{[&] {
+            _nodes[task.node].offset = task.first;
+            _nodes[task.node].count = task.count;
+        }};
+
+        if((task.count <= 2U) or (task.depth >= max_depth)) {
+            make_leaf();
+            continue;
+        }
+
+        // find the split with the lowest surface area heuristic cost
+        float best_cost{std::numeric_limits<float>::max()};
+        std::size_t best_axis{0U};
+        std::size_t best_split{0U};
+        bool found_split{false};
+
+        for(const auto a : integer_range(std_size(3))) {
+            const auto extent = centroid_bounds.extent(a);
+            if(not(extent > 0.F)) {
+                continue;
+            }
+            const auto bin_of{[&](const std::uint32_t f) -> std::size_t {
+                return bvh_bin_of(
+                  centroids[f][a], centroid_bounds.min[a], extent, bin_count);
+            }};
+
+            std::array<bvh_bounds, bin_count> bin_bounds{};
+            std::array<std::uint32_t, bin_count> bin_counts{};
+            for(auto pos = begin; pos != end; ++pos) {
+                const auto b = bin_of(*pos);
+                bin_bounds[b].merge(bounds[*pos]);
+                ++bin_counts[b];
+            }
+
+            std::array<float, bin_count> right_costs{};
+            bvh_bounds right_bounds;
+            std::uint32_t right_count{0U};
+            for(std::size_t b = bin_count - 1U; b > 0U; --b) {
+                right_bounds.merge(bin_bounds[b]);
+                right_count += bin_counts[b];
+                right_costs[b] = right_bounds.area() * float(right_count);
+            }
+
+            bvh_bounds left_bounds;
+            std::uint32_t left_count{0U};
+            for(std::size_t b = 1U; b < bin_count; ++b) {
+                left_bounds.merge(bin_bounds[b - 1U]);
+                left_count += bin_counts[b - 1U];
+                const auto cost =
+                  left_bounds.area() * float(left_count) + right_costs[b];
+                if(cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = a;
+                    best_split = b;
+                    found_split = true;
+                }
+            }
+        }
+
+        const auto leaf_cost = node_bounds.area() * float(task.count);
+        if(task.count <= max_leaf_size) {
+            if(not found_split or not(best_cost < leaf_cost)) {
+                make_leaf();
+                continue;
+            }
+        }
+
+        auto middle = begin;
+        if(found_split) {
+            const auto a = best_axis;
+            const auto extent = centroid_bounds.extent(a);
+            middle = std::partition(begin, end, [&](const std::uint32_t f) {
+                return bvh_bin_of(
+                         centroids[f][a],
+                         centroid_bounds.min[a],
+                         extent,
+                         bin_count) < best_split;
+            });
+        }
+        if((middle == begin) or (middle == end)) {
+            middle = std::next(begin, task.count / 2U);
+        }
+
+        const auto left_count =
+          limit_cast<std::uint32_t>(std::distance(begin, middle));
+        const auto first_child = limit_cast<std::uint32_t>(_nodes.size());
+        _nodes[task.node].offset = first_child;
+        _nodes[task.node].count = 0U;
+        _nodes.emplace_back();
+        _nodes.emplace_back();
+
+        tasks.push_back(
+          {first_child, task.first, left_count, task.depth + 1U});
+        tasks.push_back(
+          {first_child + 1U,
+           task.first + left_count,
+           task.count - left_count,
+           task.depth + 1U});
+    }
+
+    for(const auto c : integer_range(std_size(3))) {
+        _faces.v0[c].reserve(faces.size());
+        _faces.e1[c].reserve(faces.size());
+        _faces.e2[c].reserve(faces.size());
+        _faces.nml[c].reserve(faces.size());
+    }
+    for(const auto f : order) {
+        const auto& fce = faces[f];
+        const auto fnml = fce.triangle().normal(fce.cw_face_winding);
+        const std::array<float, 3> nml{fnml.x(), fnml.y(), fnml.z()};
+        for(const auto c : integer_range(std_size(3))) {
+            _faces.v0[c].push_back(fce.coords[c]);
+            _faces.e1[c].push_back(fce.coords[3 + c] - fce.coords[c]);
+            _faces.e2[c].push_back(fce.coords[6 + c] - fce.coords[c]);
+            _faces.nml[c].push_back(nml[c]);
+        }
+    }
+}
+//------------------------------------------------------------------------------
+auto triangle_bvh::_nearest_in_leaf(
+  const node& leaf,
+  const std::array<float, 3>& o,
+  const std::array<float, 3>& d,
+  float limit) const noexcept -> float {
+    // the triangles are tested in fixed-size groups without branching
+    // on the individual triangles, which allows the compiler to turn
+    // the inner loop into packed SIMD instructions
+    static constexpr const std::size_t lane_count{8U};
+
+    const auto* v0x = _faces.v0[0].data();
+    const auto* v0y = _faces.v0[1].data();
+    const auto* v0z = _faces.v0[2].data();
+    const auto* e1x = _faces.e1[0].data();
+    const auto* e1y = _faces.e1[1].data();
+    const auto* e1z = _faces.e1[2].data();
+    const auto* e2x = _faces.e2[0].data();
+    const auto* e2y = _faces.e2[1].data();
+    const auto* e2z = _faces.e2[2].data();
+    const auto* nx = _faces.nml[0].data();
+    const auto* ny = _faces.nml[1].data();
+    const auto* nz = _faces.nml[2].data();
+
+    const auto end = std_size(leaf.offset) + std_size(leaf.count);
+    for(auto first = std_size(leaf.offset); first < end; first += lane_count) {
+        const auto n = math::minimum(lane_count, end - first);
+        std::array<float, lane_count> params{};
+
+        for(std::size_t l = 0U; l < n; ++l) {
+            const auto f = first + l;
+            // Moller-Trumbore
+            const auto px = d[1] * e2z[f] - d[2] * e2y[f];
+            const auto py = d[2] * e2x[f] - d[0] * e2z[f];
+            const auto pz = d[0] * e2y[f] - d[1] * e2x[f];
+            const auto det = e1x[f] * px + e1y[f] * py + e1z[f] * pz;
+            const auto inv_det = 1.F / det;
+            const auto tx = o[0] - v0x[f];
+            const auto ty = o[1] - v0y[f];
+            const auto tz = o[2] - v0z[f];
+            const auto u = (tx * px + ty * py + tz * pz) * inv_det;
+            const auto qx = ty * e1z[f] - tz * e1y[f];
+            const auto qy = tz * e1x[f] - tx * e1z[f];
+            const auto qz = tx * e1y[f] - ty * e1x[f];
+            const auto v = (d[0] * qx + d[1] * qy + d[2] * qz) * inv_det;
+            const auto t = (e2x[f] * qx + e2y[f] * qy + e2z[f] * qz) * inv_det;
+            const auto facing = d[0] * nx[f] + d[1] * ny[f] + d[2] * nz[f];
+            const bool is_hit = (det != 0.F) & (u >= 0.F) & (v >= 0.F) &
+                                (u + v <= 1.F) & (t > 0.0001F) &
+                                (facing < 0.F);
+            params[l] = is_hit ? t : limit;
+        }
+        for(std::size_t l = 0U; l < n; ++l) {
+            limit = math::minimum(limit, params[l]);
+        }
+    }
+    return limit;
+}
+//------------------------------------------------------------------------------
+void triangle_bvh::ray_intersections(
+  const span<const math::line<float>> rays,
+  span<optionally_valid<float>> intersections) const noexcept {
+
+    assert(intersections.size() >= rays.size());
+
+    if(_nodes.empty()) {
+        return;
+    }
+
+    std::array<std::uint32_t, 64> stack{};
+
+    for(const auto i : index_range(rays)) {
+        const auto& ray = rays[i];
+        auto& oparam = intersections[i];
+
+        const auto orig = ray.origin();
+        const auto dir = ray.direction();
+        const std::array<float, 3> o{orig.x(), orig.y(), orig.z()};
+        const std::array<float, 3> d{dir.x(), dir.y(), dir.z()};
+        const std::array<float, 3> inv{1.F / d[0], 1.F / d[1], 1.F / d[2]};
+
+        float limit{
+          oparam ? *oparam : std::numeric_limits<float>::infinity()};
+
+        const auto entry_param{[&](const node& n) -> float {
+            float tmin{0.F};
+            float tmax{limit};
+            for(const auto c : integer_range(std_size(3))) {
+                const auto t0 = (n.min[c] - o[c]) * inv[c];
+                const auto t1 = (n.max[c] - o[c]) * inv[c];
+                tmin = std::fmax(tmin, std::fmin(t0, t1));
+                tmax = std::fmin(tmax, std::fmax(t0, t1));
+            }
+            return tmin <= tmax ? tmin
+                                : std::numeric_limits<float>::infinity();
+        }};
+
+        std::size_t depth{0U};
+        if(entry_param(_nodes.front()) <= limit) {
+            stack[depth++] = 0U;
+        }
+
+        while(depth > 0U) {
+            const auto& n = _nodes[stack[--depth]];
+            if(entry_param(n) > limit) {
+                continue;
+            }
+            if(n.count > 0U) {
+                const auto nearest = _nearest_in_leaf(n, o, d, limit);
+                if(nearest < limit) {
+                    limit = nearest;
+                    oparam = optionally_valid<float>{nearest, true};
+                }
+            } else {
+                const auto l = n.offset;
+                const auto r = n.offset + 1U;
+                const auto lparam = entry_param(_nodes[l]);
+                const auto rparam = entry_param(_nodes[r]);
+                assert(depth + 2U <= stack.size());
+                // push the farther child first, to visit the nearer one first
+                if(lparam <= rparam) {
+                    if(rparam <= limit) {
+                        stack[depth++] = r;
+                    }
+                    if(lparam <= limit) {
+                        stack[depth++] = l;
+                    }
+                } else {
+                    if(lparam <= limit) {
+                        stack[depth++] = l;
+                    }
+                    if(rparam <= limit) {
+                        stack[depth++] = r;
+                    }
+                }
+            }
+        }
+    }
+}
+//------------------------------------------------------------------------------
+ray_query_context::ray_query_context(
+  generator& gen,
+  const drawing_variant var)
+  : _bvh{std::make_shared<const triangle_bvh>(gen, var)} {}
+//------------------------------------------------------------------------------
+} // namespace eagine::shapes
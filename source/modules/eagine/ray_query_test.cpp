@@ -0,0 +1,164 @@
+/// @file
+///
+/// Copyright Matus Chochlik.
+/// Distributed under the Boost Software License, Version 1.0.
+/// See accompanying file LICENSE_1_0.txt or copy at
+/// https://www.boost.org/LICENSE_1_0.txt
+///
+
+#include <eagine/testing/unit_begin_ctx.hpp>
+import std;
+import eagine.core;
+import eagine.shapes;
+//------------------------------------------------------------------------------
+void ray_query_cube(auto& s) {
+    eagitest::case_ test{s, 1, "cube"};
+    using eagine::math::line;
+    using eagine::math::point;
+    using eagine::math::vector;
+
+    auto gen{
+      eagine::shapes::unit_cube(eagine::shapes::vertex_attrib_kind::position)};
+    test.ensure(bool(gen), "has generator");
+
+    const eagine::shapes::ray_query_context query{*gen, 0};
+    test.check(not query.is_empty(), "is not empty");
+    test.check(query.triangle_count() == 12, "triangle count");
+
+    const auto hit{query.nearest_intersection(line<float>{
+      point<float, 3>{2.F, 0.1F, 0.2F}, vector<float, 3>{-1.F, 0.F, 0.F}})};
+    test.ensure(bool(hit), "has hit");
+    test.check(std::abs(*hit - 1.5F) < 0.001F, "hit distance");
+
+    const auto miss{query.nearest_intersection(line<float>{
+      point<float, 3>{2.F, 2.F, 2.F}, vector<float, 3>{1.F, 0.F, 0.F}})};
+    test.check(not miss, "has no hit");
+
+    const auto back{query.nearest_intersection(line<float>{
+      point<float, 3>{0.F, 0.F, 0.F}, vector<float, 3>{0.F, 1.F, 0.F}})};
+    test.check(not back, "ignores back faces");
+}
+//------------------------------------------------------------------------------
+void ray_query_linear(auto& s) {
+    eagitest::case_ test{s, 2, "same as linear"};
+    eagitest::track trck{test, 0, 1};
+    using eagine::math::line;
+    using eagine::math::point;
+
+    auto gen{eagine::shapes::unit_torus(
+      eagine::shapes::vertex_attrib_kind::position, 12, 24, 0.5F)};
+    test.ensure(bool(gen), "has generator");
+
+    const eagine::shapes::ray_query_context query{*gen, 0};
+
+    std::vector<line<float>> rays;
+    for(const auto o : eagine::integer_range(27)) {
+        const point<float, 3> orig{
+          float(o % 3 - 1) * 0.7F + 0.013F,
+          float((o / 3) % 3 - 1) * 0.3F + 0.007F,
+          float(o / 9 - 1) * 0.7F + 0.011F};
+        for(const auto d : eagine::integer_range(36)) {
+            const eagine::math::unit_spherical_coordinate<float> usc{
+              eagine::turns_((float(d % 12) + 0.37F) / 12.F),
+              eagine::radians_(float(d / 12 + 1) * 0.78F)};
+            rays.emplace_back(orig, eagine::math::to_cartesian(usc));
+        }
+    }
+
+    std::vector<eagine::optionally_valid<float>> linear(rays.size());
+    std::vector<eagine::optionally_valid<float>> queried(rays.size());
+    gen->ray_intersections(
+      *gen, 0, eagine::view(rays), eagine::cover(linear));
+    query.ray_intersections(eagine::view(rays), eagine::cover(queried));
+
+    for(const auto i : eagine::index_range(rays)) {
+        test.check(bool(linear[i]) == bool(queried[i]), "same hit");
+        if(linear[i] and queried[i]) {
+            test.check(
+              std::abs(*linear[i] - *queried[i]) < 0.0001F, "same distance");
+        }
+        trck.checkpoint(1);
+    }
+}
+//------------------------------------------------------------------------------
+void ray_query_bounds(auto& s) {
+    eagitest::case_ test{s, 3, "bounds"};
+    using eagine::shapes::vertex_attrib_kind;
+
+    auto gen{eagine::shapes::translate(
+      eagine::shapes::unit_torus(vertex_attrib_kind::position, 12, 24, 0.5F),
+      {1.F, 2.F, 3.F})};
+    test.ensure(bool(gen), "has generator");
+
+    const auto bb{gen->bounding_box()};
+    const auto bs{gen->bounding_sphere()};
+    test.check(bs.radius() <= bb.enclosing_sphere().radius(), "tight sphere");
+
+    const auto pos{eagine::shapes::shared_attrib_values<float>(
+      *gen, vertex_attrib_kind::position)};
+    for(const auto v : eagine::integer_range(std::size_t(pos.size() / 3))) {
+        const std::array<float, 3> p{
+          pos[v * 3 + 0], pos[v * 3 + 1], pos[v * 3 + 2]};
+        const std::array<float, 3> c{
+          bs.center().x(), bs.center().y(), bs.center().z()};
+        float dist{0.F};
+        for(const auto k : eagine::integer_range(std::size_t(3))) {
+            test.check(bb.min[k] <= p[k] and p[k] <= bb.max[k], "in box");
+            dist += (p[k] - c[k]) * (p[k] - c[k]);
+        }
+        test.check(std::sqrt(dist) <= bs.radius(), "in sphere");
+    }
+
+    const auto cube{eagine::shapes::scale(
+      eagine::shapes::unit_cube(vertex_attrib_kind::position),
+      {2.F, -1.F, 1.F})};
+    const auto cb{cube->bounding_box()};
+    test.check(cb.min[0] == -1.F and cb.max[0] == 1.F, "scaled x");
+    test.check(cb.min[1] == -0.5F and cb.max[1] == 0.5F, "mirrored y");
+
+    // the analytic boxes of the shapes enclose all their vertices
+    const auto check_box{[&](auto shape, const char* name) {
+        const auto box{shape->bounding_box()};
+        const auto values{eagine::shapes::shared_attrib_values<float>(
+          *shape, vertex_attrib_kind::position)};
+        const auto vpv{
+          shape->values_per_vertex(vertex_attrib_kind::position)};
+        for(const auto v : eagine::integer_range(values.size() / vpv)) {
+            for(const auto k : eagine::integer_range(vpv)) {
+                const auto p{values[v * vpv + k]};
+                const auto c{eagine::std_size(k)};
+                test.check(
+                  box.min[c] - 0.0001F <= p and p <= box.max[c] + 0.0001F,
+                  name);
+            }
+        }
+    }};
+    check_box(
+      eagine::shapes::unit_icosahedron(vertex_attrib_kind::position),
+      "icosahedron");
+    check_box(
+      eagine::shapes::unit_round_cube(vertex_attrib_kind::position),
+      "round cube");
+    check_box(
+      eagine::shapes::unit_torus(vertex_attrib_kind::position, 12, 24, 0.3F),
+      "torus");
+    check_box(
+      eagine::shapes::unit_twisted_torus(vertex_attrib_kind::position),
+      "twisted torus");
+}
+//------------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------------
+auto test_main(eagine::test_ctx& ctx) -> int {
+    eagitest::ctx_suite test{ctx, "ray_query", 3};
+    test.once(ray_query_cube);
+    test.once(ray_query_linear);
+    test.once(ray_query_bounds);
+    return test.exit_code();
+}
+//------------------------------------------------------------------------------
+auto main(int argc, const char** argv) -> int {
+    return eagine::test_main_impl(argc, argv, test_main);
+}
+//------------------------------------------------------------------------------
+#include <eagine/testing/unit_end_ctx.hpp>
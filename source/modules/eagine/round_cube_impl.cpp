@@ -142,6 +142,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
 private:
     using _base = generator_base;
 
@@ -475,5 +477,9 @@ auto unit_round_cube_gen::bounding_sphere() -> math::sphere<float> {
     return {{}, 1.F};
 }
 //------------------------------------------------------------------------------
+auto unit_round_cube_gen::bounding_box() -> shape_bounding_box {
+    return {{-0.5F, -0.5F, -0.5F}, {0.5F, 0.5F, 0.5F}};
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
 
@@ -25,6 +25,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
 private:
     std::array<float, 3> _s;
 };
@@ -61,8 +63,24 @@ void scaled_gen::attrib_values(
 //------------------------------------------------------------------------------
 auto scaled_gen::bounding_sphere() -> math::sphere<float> {
     const auto bs = delegated_gen::bounding_sphere();
-    const auto ms = math::maximum(_s[0], math::maximum(_s[1], _s[2]));
-    return {bs.center(), bs.radius() * ms};
+    const auto c = bs.center();
+    const auto ms = math::maximum(
+      std::abs(_s[0]), math::maximum(std::abs(_s[1]), std::abs(_s[2])));
+    return {
+      math::point<float, 3>{c.x() * _s[0], c.y() * _s[1], c.z() * _s[2]},
+      bs.radius() * ms};
+}
+//------------------------------------------------------------------------------
+auto scaled_gen::bounding_box() -> shape_bounding_box {
+    const auto bb = delegated_gen::bounding_box();
+    shape_bounding_box result;
+    for(const auto c : integer_range(std_size(3))) {
+        const auto a = bb.min[c] * _s[c];
+        const auto b = bb.max[c] * _s[c];
+        result.min[c] = math::minimum(a, b);
+        result.max[c] = math::maximum(a, b);
+    }
+    return result;
 }
 //------------------------------------------------------------------------------
 } // namespace eagine::shapes
@@ -16,6 +16,8 @@ export import :generator;
 export import :delegated;
 export import :primitive_info;
 export import :topology;
+export import :ray_query;
+export import :occlusion;
 export import :to_json;
 
 namespace eagine::shapes {
@@ -34,4 +36,53 @@ export [[nodiscard]] auto shape_from(const url& locator, main_ctx& ctx)
     return shape_from({}, locator, ctx);
 }
 //------------------------------------------------------------------------------
+/// @brief Returns a shared cached generator of the shape specified by an URL.
+/// @see shape_from
+/// @see cache
+///
+/// Requests for the same shape, with the same attributes and URL arguments
+/// regardless of their order, share a single cached generator, so that the
+/// shape data is generated and stored only once in the process. The shared
+/// generator is released once it is no longer used by any of the requesters.
+/// The capabilities of the shared generator cannot be enabled or disabled
+/// through the returned generators, enable only reports if the capability
+/// already is in the requested state. This function can be called
+/// concurrently from multiple threads.
+export [[nodiscard]] auto shared_shape_from(
+  vertex_attrib_kinds,
+  const url&,
+  main_ctx&) -> shared_holder<generator>;
+
+export [[nodiscard]] auto shared_shape_from(const url& locator, main_ctx& ctx)
+  -> shared_holder<generator> {
+    return shared_shape_from({}, locator, ctx);
+}
+//------------------------------------------------------------------------------
+/// @brief Returns a key uniquely describing the shape specified by an URL.
+/// @see shared_shape_from
+/// @see persistent_cache
+///
+/// The key does not depend on the order of the URL arguments and includes
+/// the requested vertex attributes, so it can be used as the key of
+/// persistent_cache for shapes constructed by shape_from.
+export [[nodiscard]] auto shape_key(vertex_attrib_kinds, const url&)
+  -> std::string;
+
+/// @brief Returns a generator of the shape specified by an URL persisted in a directory.
+/// @see shape_from
+/// @see shape_key
+/// @see persistent_cache
+export [[nodiscard]] auto persistent_shape_from(
+  vertex_attrib_kinds,
+  const url&,
+  const std::filesystem::path& directory,
+  main_ctx&) -> shared_holder<generator>;
+
+export [[nodiscard]] auto persistent_shape_from(
+  const url& locator,
+  const std::filesystem::path& directory,
+  main_ctx& ctx) -> shared_holder<generator> {
+    return persistent_shape_from({}, locator, directory, ctx);
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
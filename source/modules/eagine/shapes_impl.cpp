@@ -94,4 +94,193 @@ auto shape_from(vertex_attrib_kinds attrs, const url& locator, main_ctx& ctx)
     return {};
 }
 //------------------------------------------------------------------------------
+// shared shapes
+//------------------------------------------------------------------------------
+struct shared_shape_entry {
+    shared_holder<generator> gen;
+};
+//------------------------------------------------------------------------------
+class shared_shape_gen : public delegated_gen {
+public:
+    shared_shape_gen(std::shared_ptr<const shared_shape_entry> entry) noexcept
+      : delegated_gen{entry->gen}
+      , _entry{std::move(entry)} {}
+
+    // changing the capabilities of the shared generator would affect
+    // all the other holders of the shape, only the current ones are kept
+    auto enable(const generator_capability cap, const bool value) noexcept
+      -> bool final {
+        return is_enabled(cap) == value;
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<byte> tid) -> shared_data_view<byte> final {
+        return base_generator()->attrib_values_view(vav, tid);
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::int16_t> tid)
+      -> shared_data_view<std::int16_t> final {
+        return base_generator()->attrib_values_view(vav, tid);
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::int32_t> tid)
+      -> shared_data_view<std::int32_t> final {
+        return base_generator()->attrib_values_view(vav, tid);
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::uint16_t> tid)
+      -> shared_data_view<std::uint16_t> final {
+        return base_generator()->attrib_values_view(vav, tid);
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<std::uint32_t> tid)
+      -> shared_data_view<std::uint32_t> final {
+        return base_generator()->attrib_values_view(vav, tid);
+    }
+
+    auto attrib_values_view(
+      const vertex_attrib_variant vav,
+      std::type_identity<float> tid) -> shared_data_view<float> final {
+        return base_generator()->attrib_values_view(vav, tid);
+    }
+
+    auto indices_view(
+      const drawing_variant var,
+      std::type_identity<std::uint8_t> tid)
+      -> shared_data_view<std::uint8_t> final {
+        return base_generator()->indices_view(var, tid);
+    }
+
+    auto indices_view(
+      const drawing_variant var,
+      std::type_identity<std::uint16_t> tid)
+      -> shared_data_view<std::uint16_t> final {
+        return base_generator()->indices_view(var, tid);
+    }
+
+    auto indices_view(
+      const drawing_variant var,
+      std::type_identity<std::uint32_t> tid)
+      -> shared_data_view<std::uint32_t> final {
+        return base_generator()->indices_view(var, tid);
+    }
+
+    auto instructions_view(const drawing_variant var)
+      -> shared_data_view<draw_operation> final {
+        return base_generator()->instructions_view(var);
+    }
+
+    void ray_intersections(
+      generator& gen,
+      const drawing_variant var,
+      const span<const math::line<float>> rays,
+      span<optionally_valid<float>> intersections) final {
+        // let the shared cache use its prepared triangle hierarchy
+        auto& base = *base_generator();
+        base.ray_intersections(
+          &gen == this ? base : gen, var, rays, intersections);
+    }
+
+private:
+    std::shared_ptr<const shared_shape_entry> _entry;
+};
+//------------------------------------------------------------------------------
+auto shape_key(const vertex_attrib_kinds attrs, const url& locator)
+  -> std::string {
+    auto key{to_string(locator.str())};
+    // the order of the query arguments does not change the shape
+    if(const auto pos{key.find('?')}; pos != std::string::npos) {
+        std::vector<std::string> args;
+        std::string::size_type begin{pos + 1U};
+        while(begin <= key.size()) {
+            auto end{key.find('&', begin)};
+            if(end == std::string::npos) {
+                end = key.size();
+            }
+            if(end > begin) {
+                args.emplace_back(key, begin, end - begin);
+            }
+            begin = end + 1U;
+        }
+        std::sort(args.begin(), args.end());
+        key.resize(pos + 1U);
+        for(const auto& arg : args) {
+            key.append(arg).push_back('&');
+        }
+    }
+    key.push_back('|');
+    for(const auto& info : enumerators<shapes::vertex_attrib_kind>()) {
+        if(attrs.has(info.enumerator)) {
+            key.append(info.name.std_view()).push_back(',');
+        }
+    }
+    return key;
+}
+//------------------------------------------------------------------------------
+auto shared_shape_from(
+  const vertex_attrib_kinds attrs,
+  const url& locator,
+  main_ctx& ctx) -> shared_holder<generator> {
+    static std::mutex registry_mutex;
+    static std::map<std::string, std::weak_ptr<const shared_shape_entry>>
+      registry;
+
+    const auto key{shape_key(attrs, locator)};
+    const auto find_entry{[&]() -> std::shared_ptr<const shared_shape_entry> {
+        if(auto found{find(registry, key)}) {
+            return (*found).lock();
+        }
+        return {};
+    }};
+
+    {
+        const std::lock_guard<std::mutex> lock{registry_mutex};
+        if(auto entry{find_entry()}) {
+            return {hold<shared_shape_gen>, std::move(entry)};
+        }
+    }
+
+    // the shape is generated outside of the lock, if another thread
+    // registers the same shape meanwhile, its entry is used instead
+    auto gen{shape_from(attrs, locator, ctx)};
+    if(not gen) {
+        return {};
+    }
+    auto entry{std::make_shared<const shared_shape_entry>(
+      cache(std::move(gen), ctx))};
+
+    const std::lock_guard<std::mutex> lock{registry_mutex};
+    if(auto existing{find_entry()}) {
+        entry = std::move(existing);
+    } else {
+        // drop the entries of shapes that are no longer used
+        std::erase_if(registry, [](const auto& registered) {
+            return std::get<1>(registered).expired();
+        });
+        registry[key] = entry;
+    }
+    return {hold<shared_shape_gen>, std::move(entry)};
+}
+//------------------------------------------------------------------------------
+auto persistent_shape_from(
+  const vertex_attrib_kinds attrs,
+  const url& locator,
+  const std::filesystem::path& directory,
+  main_ctx& ctx) -> shared_holder<generator> {
+    if(auto gen{shape_from(attrs, locator, ctx)}) {
+        return persistent_cache(
+          std::move(gen), shape_key(attrs, locator), directory, ctx);
+    }
+    return {};
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
@@ -46,6 +46,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
 private:
     using _base = generator_base;
 
@@ -266,7 +268,14 @@ void skybox_gen::instructions(
 //------------------------------------------------------------------------------
 auto skybox_gen::bounding_sphere() -> math::sphere<float> {
     using std::sqrt;
-    return {{}, float(sqrt(2.F))};
+    // the corners and the face centers are all at the same distance
+    return {{}, float(sqrt(3.F))};
+}
+//------------------------------------------------------------------------------
+auto skybox_gen::bounding_box() -> shape_bounding_box {
+    return {
+      {-std::sqrt(3.F), -std::sqrt(3.F), -std::sqrt(3.F)},
+      {std::sqrt(3.F), std::sqrt(3.F), std::sqrt(3.F)}};
 }
 //------------------------------------------------------------------------------
 } // namespace eagine::shapes
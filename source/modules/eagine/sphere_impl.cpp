@@ -56,6 +56,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
     void ray_intersections(
       generator& gen,
       const drawing_variant,
@@ -342,6 +344,10 @@ auto unit_sphere_gen::bounding_sphere() -> math::sphere<float> {
     return {{}, 0.5F};
 }
 //------------------------------------------------------------------------------
+auto unit_sphere_gen::bounding_box() -> shape_bounding_box {
+    return {{-0.5F, -0.5F, -0.5F}, {0.5F, 0.5F, 0.5F}};
+}
+//------------------------------------------------------------------------------
 void unit_sphere_gen::ray_intersections(
   generator& gen,
   const drawing_variant,
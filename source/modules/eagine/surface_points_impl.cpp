@@ -32,6 +32,13 @@ public:
       const vertex_attrib_variant weight_variant,
       main_ctx_parent parent) noexcept;
 
+    surface_points_gen(
+      shared_holder<generator> gen,
+      const span_size_t point_count,
+      std::optional<vertex_attrib_variant> weight_variant,
+      std::filesystem::path topology_dir,
+      main_ctx_parent parent) noexcept;
+
     auto vertex_count() -> span_size_t override;
     void attrib_values(const vertex_attrib_variant, span<float>) override;
 
@@ -50,6 +57,7 @@ private:
 
     const span_size_t _point_count{0};
     topology_options _topo_opts;
+    std::filesystem::path _topology_dir;
 
     std::map<drawing_variant, ext_topology> _topologies;
 };
@@ -74,6 +82,35 @@ auto surface_points(
       parent};
 }
 //------------------------------------------------------------------------------
+auto surface_points(
+  shared_holder<generator> gen,
+  const span_size_t point_count,
+  const std::filesystem::path& topology_dir,
+  main_ctx_parent parent) noexcept -> shared_holder<generator> {
+    return {
+      hold<surface_points_gen>,
+      std::move(gen),
+      point_count,
+      std::nullopt,
+      topology_dir,
+      parent};
+}
+//------------------------------------------------------------------------------
+auto surface_points(
+  shared_holder<generator> gen,
+  const span_size_t point_count,
+  const vertex_attrib_variant weight_variant,
+  const std::filesystem::path& topology_dir,
+  main_ctx_parent parent) noexcept -> shared_holder<generator> {
+    return {
+      hold<surface_points_gen>,
+      std::move(gen),
+      point_count,
+      weight_variant,
+      topology_dir,
+      parent};
+}
+//------------------------------------------------------------------------------
 surface_points_gen::surface_points_gen(
   shared_holder<generator> gen,
   const span_size_t point_count,
@@ -94,19 +131,40 @@ surface_points_gen::surface_points_gen(
     _topo_opts.weight_variant = weight_variant;
 }
 //------------------------------------------------------------------------------
+surface_points_gen::surface_points_gen(
+  shared_holder<generator> gen,
+  const span_size_t point_count,
+  std::optional<vertex_attrib_variant> weight_variant,
+  std::filesystem::path topology_dir,
+  main_ctx_parent parent) noexcept
+  : surface_points_gen{std::move(gen), point_count, parent} {
+    if(weight_variant) {
+        _topo_opts.features.set(topology_feature_bit::triangle_weight);
+        _topo_opts.weight_variant = *weight_variant;
+    }
+    _topology_dir = std::move(topology_dir);
+}
+//------------------------------------------------------------------------------
 auto surface_points_gen::_topology(const drawing_variant var) noexcept
   -> ext_topology& {
     auto found{find(_topologies, var)};
     if(not found) {
         auto gen = delegated_gen::base_generator();
-        found.emplace(var, ext_topology{gen, _topo_opts, this->as_parent()});
+        if(_topology_dir.empty()) {
+            found.emplace(
+              var, ext_topology{gen, _topo_opts, this->as_parent()});
+        } else {
+            found.emplace(
+              var,
+              ext_topology{gen, _topo_opts, _topology_dir, this->as_parent()});
+        }
         auto& topo = *found;
 
         std::vector<float> triangle_areas;
         triangle_areas.reserve(std_size(topo.triangle_count()));
         float accumulated = 0.F;
         for(const auto t : integer_range(topo.triangle_count())) {
-            const auto& tri = topo.triangle(t);
+            const auto tri{topo.triangle(t)};
             accumulated += tri.area() * tri.weight();
             triangle_areas.push_back(accumulated);
         }
@@ -166,7 +224,7 @@ void surface_points_gen::attrib_values(
 
     span_size_t k = 0;
     for(const auto& [idx, bary] : topo.point_params) {
-        const auto& tri = topo.triangle(idx);
+        const auto tri{topo.triangle(idx)};
         for(const auto e : integer_range(3)) {
             const auto i = tri.vertex_index(e);
             for(const auto v : integer_range(vpv)) {
@@ -46,6 +46,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
 private:
     using _base = generator_base;
 
@@ -258,4 +260,9 @@ auto marching_tetrahedrons_gen::bounding_sphere() -> math::sphere<float> {
     return {{}, 0.5F};
 }
 //------------------------------------------------------------------------------
+auto marching_tetrahedrons_gen::bounding_box() -> shape_bounding_box {
+    // there are no positions to scan, the box is the unit cube
+    return {{-0.5F, -0.5F, -0.5F}, {0.5F, 0.5F, 0.5F}};
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
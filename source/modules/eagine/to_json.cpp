@@ -37,6 +37,11 @@ export [[nodiscard]] auto parse_from(
 //------------------------------------------------------------------------------
 export auto to_json(std::ostream&, generator&, const to_json_options&)
   -> std::ostream&;
+
+/// @brief Writes the statistics collected by the instrumentation as JSON.
+/// @see instrument
+export auto to_json(std::ostream&, const generator_instrumentation&)
+  -> std::ostream&;
 //------------------------------------------------------------------------------
 } // namespace eagine::shapes
 
@@ -89,10 +89,7 @@ auto to_json(std::ostream& out, generator& gen, const to_json_options& opts)
             }
 
             out << R"(,"data":[)";
-            const auto print_data{[&out, &gen, vav, size](auto& data) {
-                data.resize(integer(size));
-                gen.attrib_values(vav, cover(data));
-
+            const auto print_data{[&out](const auto& data) {
                 interleaved_call print_elem(
                   [&out](const auto v) { out << v; }, [&out] { out << ','; });
                 for(const auto v : data) {
@@ -101,8 +98,7 @@ auto to_json(std::ostream& out, generator& gen, const to_json_options& opts)
             }};
 
             if(data_type == attrib_data_type::float_) {
-                std::vector<float> data;
-                print_data(data);
+                print_data(shared_attrib_values<float>(gen, vav));
             }
             out << "]\n";
         }
@@ -113,10 +109,9 @@ auto to_json(std::ostream& out, generator& gen, const to_json_options& opts)
     out << R"(,"index_type":")" << enumerator_name(idx_type) << '"' << '\n';
 
     if(idx_type != index_data_type::none) {
-        std::vector<std::uint32_t> indices;
-        indices.resize(integer(gen.index_count(opts.draw_variant)));
+        const auto indices{
+          shared_indices<std::uint32_t>(gen, opts.draw_variant)};
         if(not indices.empty()) {
-            gen.indices(opts.draw_variant, cover(indices));
             out << R"(,"indices":[)";
             interleaved_call print_idx(
               [&out](const auto i) { out << i; }, [&out] { out << ','; });
@@ -127,29 +122,27 @@ auto to_json(std::ostream& out, generator& gen, const to_json_options& opts)
         }
     }
 
-    std::vector<draw_operation> operations;
-    operations.resize(integer(gen.operation_count(opts.draw_variant)));
+    const auto operations{shared_instructions(gen, opts.draw_variant)};
     if(not operations.empty()) {
-        gen.instructions(opts.draw_variant, cover(operations));
         out << R"(,"instructions":[{)";
 
         const draw_operation cmp{};
         const auto should_print_phase = any_of(
-          view(operations),
+          operations.values(),
           [cmp](const auto& op) { return op.phase != cmp.phase; });
         const auto should_print_index_type = any_of(
-          view(operations),
+          operations.values(),
           [cmp](const auto& op) { return op.idx_type != cmp.idx_type; });
         const auto should_print_pr =
-          any_of(view(operations), [cmp](const auto& op) {
+          any_of(operations.values(), [cmp](const auto& op) {
               return op.primitive_restart != cmp.primitive_restart;
           });
         const auto should_print_pri =
-          any_of(view(operations), [cmp](const auto& op) {
+          any_of(operations.values(), [cmp](const auto& op) {
               return op.primitive_restart_index != cmp.primitive_restart_index;
           });
         const auto should_print_patch_verts =
-          any_of(view(operations), [cmp](const auto& op) {
+          any_of(operations.values(), [cmp](const auto& op) {
               return op.patch_vertices != cmp.patch_vertices;
           });
 
@@ -194,4 +187,34 @@ auto to_json(std::ostream& out, generator& gen, const to_json_options& opts)
     return out;
 }
 //------------------------------------------------------------------------------
+auto to_json(std::ostream& out, const generator_instrumentation& instr)
+  -> std::ostream& {
+    const auto print_calls{
+      [&out](const char* name, const generator_call_statistics& stats) {
+          out << R"(,")" << name << R"(":{"calls":)" << stats.call_count
+              << R"(,"bytes":)" << stats.byte_count << R"(,"view_bytes":)"
+              << stats.view_byte_count << R"(,"rays":)" << stats.ray_count
+              << R"(,"seconds":)"
+              << std::chrono::duration<double>(stats.duration).count()
+              << "}\n";
+      }};
+
+    out << R"({"nodes":[)";
+    interleaved_call print_node(
+      [&](const generator_node_statistics& node) {
+          out << R"({"name":")" << node.name << '"' << '\n';
+          print_calls("attrib_values", node.attrib_values);
+          print_calls("indices", node.indices);
+          print_calls("instructions", node.instructions);
+          print_calls("ray_intersections", node.ray_intersections);
+          out << '}';
+      },
+      [&out] { out << ",\n"; });
+    for(const auto& node : instr.report()) {
+        print_node(node);
+    }
+    out << "]}";
+    return out;
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
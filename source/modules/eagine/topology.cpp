@@ -23,154 +23,93 @@ import :generator;
 namespace eagine::shapes {
 //------------------------------------------------------------------------------
 export struct topology_data;
+export class topology;
 export class mesh_triangle;
 
-/// @brief Class storing information about an edge between two mesh faces.
+/// @brief Class providing information about an edge between two mesh faces.
 /// @ingroup  shapes
 /// @see mesh_triangle
 /// @see topology
+///
+/// This is a lightweight accessor of the data stored in the topology,
+/// it is only valid as long as the topology is alive and not moved.
 export class mesh_edge {
 public:
-    mesh_edge(
-      mesh_triangle& a,
-      const std::uint8_t aeb,
-      const std::uint8_t aee,
-      mesh_triangle& b,
-      const std::uint8_t beb,
-      const std::uint8_t bee) noexcept
-      : _triangles{{&a, &b}}
-      , _edge_indices{{aeb, aee, beb, bee}} {}
+    mesh_edge(const topology& topo, const std::size_t edge_idx) noexcept
+      : _topo{&topo}
+      , _edge_idx{edge_idx} {}
 
     /// @brief Returns one of the two adjacent triangle faces.
     /// @pre i >= 0 and i < 2
-    auto triangle(const span_size_t i) const noexcept -> const mesh_triangle& {
-        assert(i >= 0 and i < 2);
-        return *_triangles[integer(i)];
-    }
+    auto triangle(const span_size_t i) const noexcept -> mesh_triangle;
 
     /// @brief Returns a pair of vertex indices (0,1 or 2) defining the i-th edge.
     /// @pre i >= 0 and i < 2
     auto edge_vertices(const span_size_t i) const noexcept
-      -> std::tuple<unsigned, unsigned> {
-        assert(i >= 0 and i < 2);
-        return {
-          _edge_indices[integer(2 * i)], _edge_indices[integer(2 * i + 1)]};
-    }
+      -> std::tuple<unsigned, unsigned>;
 
 private:
-    std::array<mesh_triangle*, 2> _triangles;
-    std::array<std::uint8_t, 4> _edge_indices;
+    const topology* _topo;
+    std::size_t _edge_idx;
 };
 //------------------------------------------------------------------------------
-/// @brief Class storing information about a mesh triangular face.
+/// @brief Class providing information about a mesh triangular face.
 /// @ingroup  shapes
 /// @see mesh_edge
 /// @see topology
+///
+/// This is a lightweight accessor of the data stored in the topology,
+/// it is only valid as long as the topology is alive and not moved.
 export class mesh_triangle {
 public:
-    mesh_triangle(
-      const std::size_t tri_idx,
-      const unsigned a,
-      const unsigned b,
-      const unsigned c) noexcept
-      : _tri_idx{tri_idx}
-      , _indices{{a, b, c}} {}
+    mesh_triangle(const topology& topo, const std::size_t tri_idx) noexcept
+      : _topo{&topo}
+      , _tri_idx{tri_idx} {}
 
     /// @brief Returns the index of this triangle within the mesh.
     auto index() const noexcept -> span_size_t {
         return span_size(_tri_idx);
     }
 
-    auto setup_adjacent(mesh_triangle& that, const topology_data& d) noexcept
-      -> std::tuple<bool, std::uint8_t, std::uint8_t, std::uint8_t, std::uint8_t>;
-
     /// @brief Returns the v-th vertex index.
     /// @pre v >= 0 and v < 3
-    auto vertex_index(const span_size_t v) const noexcept {
-        assert(v >= 0 and v < 3);
-        return _indices[integer(v)];
-    }
+    auto vertex_index(const span_size_t v) const noexcept -> unsigned;
 
-    /// @brief Returns the triangle adjacent through the v-th edge.
+    /// @brief Returns the triangle adjacent through the v-th edge, if any.
     /// @pre v >= 0 and v < 3
     /// @see opposite_vertex
     auto adjacent_triangle(const span_size_t v) const noexcept
-      -> const mesh_triangle* {
-        assert(v >= 0 and v < 3);
-        return _adjacent[integer(v)];
-    }
+      -> std::optional<mesh_triangle>;
 
     /// @brief Returns opposite vertex index (0,1 or 2) in the v-th adjacent triangle.
     /// @pre v >= 0 and v < 3
     /// @see adjacent_triangle
     /// @see opposite_index
-    auto opposite_vertex(const span_size_t v) const noexcept -> unsigned {
-        assert(v >= 0 and v < 3);
-        return _opposite[integer(v)];
-    }
+    auto opposite_vertex(const span_size_t v) const noexcept -> unsigned;
 
     /// @brief Returns the in-mesh index of the v-th adjacent vertex.
     /// @pre v >= 0 and v < 3
     /// @see opposite_vertex
     /// @see adjacent_triangle
     auto opposite_index(const span_size_t v) const noexcept -> unsigned {
-        if(auto tri{adjacent_triangle(v)}) {
+        if(const auto tri{adjacent_triangle(v)}) {
             return tri->vertex_index(opposite_vertex(v));
         }
-        return _indices[(v + 2) % 3];
-    }
-
-    auto set_area(float a) noexcept -> auto& {
-        _area = a;
-        return *this;
+        return vertex_index((v + 2) % 3);
     }
 
     /// @brief Returns the area of the triangle.
-    auto area() const noexcept -> float {
-        return _area;
-    }
-
-    auto set_weight(float w) noexcept -> auto& {
-        _weight = w;
-        return *this;
-    }
+    auto area() const noexcept -> float;
 
     /// @brief Returns the weight of the triangle.
-    auto weight() const noexcept -> float {
-        return _weight;
-    }
-
-private:
-    auto curri(const std::size_t i) const noexcept -> unsigned {
-        return _indices[i];
-    }
-
-    static auto prevv(const std::size_t i) noexcept -> unsigned {
-        return (i + 2) % 3;
-    }
+    auto weight() const noexcept -> float;
 
-    auto previ(const std::size_t i) const noexcept -> unsigned {
-        return _indices[prevv(i)];
-    }
+    /// @brief Indicates if this and that refer to the same triangle.
+    auto operator==(const mesh_triangle&) const noexcept -> bool = default;
 
-    static auto nextv(const std::size_t i) noexcept -> unsigned {
-        return (i + 1) % 3;
-    }
-
-    auto nexti(const std::size_t i) const noexcept -> unsigned {
-        return _indices[nextv(i)];
-    }
-
-    static auto narrow(const std::size_t i) noexcept -> std::uint8_t {
-        return limit_cast<std::uint8_t>(i);
-    }
-
-    std::size_t _tri_idx{~0U};
-    std::array<unsigned, 3> _indices{};
-    float _area{1.F};
-    float _weight{1.F};
-    std::array<mesh_triangle*, 3> _adjacent{{nullptr, nullptr, nullptr}};
-    std::array<std::uint8_t, 3> _opposite{{0, 0, 0}};
+private:
+    const topology* _topo;
+    std::size_t _tri_idx;
 };
 //------------------------------------------------------------------------------
 /// @brief Enumeration of shape topology features that can be analysed.
@@ -184,7 +123,11 @@ export enum class topology_feature_bit : unsigned {
     /// @brief Shape triangle weight (from vertex weight).
     triangle_weight = 1U << 2U,
     /// @brief Shape triangle area.
-    edge_length = 1U << 3U
+    edge_length = 1U << 3U,
+    /// @brief Half-edge representation of the mesh (implies adjacency).
+    half_edges = 1U << 4U,
+    /// @brief Connected components of the mesh (implies adjacency).
+    connected_components = 1U << 5U
 };
 //------------------------------------------------------------------------------
 /// @brief Shape topology features bitfield.
@@ -195,7 +138,7 @@ export using topology_feature_bits = bitfield<topology_feature_bit>;
 /// @ingroup shapes
 export constexpr auto all_topology_features() noexcept
   -> topology_feature_bits {
-    return topology_feature_bits{(1U << 4U) - 1U};
+    return topology_feature_bits{(1U << 6U) - 1U};
 }
 //------------------------------------------------------------------------------
 /// @brief Bitwise-or operator for vertex_attrib_kind bits.
@@ -215,10 +158,198 @@ export struct topology_options {
     constexpr topology_options() noexcept = default;
 };
 //------------------------------------------------------------------------------
+/// @brief Returns a hash of the generator data and options a topology uses.
+/// @ingroup shapes
+/// @see topology::write_to
+///
+/// The hash covers the vertex positions and weights, the indices and draw
+/// operations of the drawing variant and the requested topology features.
+export auto topology_source_hash(generator&, const topology_options&)
+  -> std::uint64_t;
+//------------------------------------------------------------------------------
+/// @brief Half-edge representation of a triangle mesh.
+/// @ingroup shapes
+/// @see topology
+/// @see topology_feature_bit::half_edges
+///
+/// The half-edge h is the edge (h % 3) of the triangle (h / 3), going from
+/// its (h % 3)-th vertex to the next one. The vertices are identified by
+/// the lowest index of the vertices at the same position.
+export class mesh_half_edges {
+public:
+    /// @brief Alias for the half-edge index type. Negative means none.
+    using index_type = std::int32_t;
+
+    /// @brief Iterator over the half-edges going out of a vertex.
+    /// @see one_ring
+    class one_ring_iterator {
+    public:
+        one_ring_iterator() noexcept = default;
+        one_ring_iterator(
+          const mesh_half_edges& mesh,
+          const index_type start) noexcept
+          : _mesh{&mesh}
+          , _start{start}
+          , _current{start} {}
+
+        auto operator*() const noexcept -> index_type {
+            return _current;
+        }
+
+        auto operator++() noexcept -> auto& {
+            const auto t{_mesh->twin(prev(_current))};
+            _current = (t == _start) ? -1 : t;
+            return *this;
+        }
+
+        auto operator==(const one_ring_iterator& that) const noexcept
+          -> bool {
+            return _current == that._current;
+        }
+
+    private:
+        const mesh_half_edges* _mesh{nullptr};
+        index_type _start{-1};
+        index_type _current{-1};
+    };
+
+    /// @brief Range of the half-edges going out of a vertex.
+    /// @see one_ring
+    class one_ring_range {
+    public:
+        one_ring_range(
+          const mesh_half_edges& mesh,
+          const index_type start) noexcept
+          : _begin{mesh, start} {}
+
+        auto begin() const noexcept -> one_ring_iterator {
+            return _begin;
+        }
+
+        auto end() const noexcept -> one_ring_iterator {
+            return {};
+        }
+
+    private:
+        one_ring_iterator _begin;
+    };
+
+    /// @brief Indicates if the half-edges were not built.
+    auto is_empty() const noexcept -> bool {
+        return _twin.empty();
+    }
+
+    /// @brief Returns the number of half-edges (three per triangle).
+    auto half_edge_count() const noexcept -> span_size_t {
+        return span_size(_twin.size());
+    }
+
+    /// @brief Returns the number of mesh vertices.
+    auto vertex_count() const noexcept -> span_size_t {
+        return span_size(_vertex_half_edge.size());
+    }
+
+    /// @brief Returns the next half-edge in the same triangle.
+    static constexpr auto next(const index_type h) noexcept -> index_type {
+        return h - h % 3 + (h + 1) % 3;
+    }
+
+    /// @brief Returns the previous half-edge in the same triangle.
+    static constexpr auto prev(const index_type h) noexcept -> index_type {
+        return h - h % 3 + (h + 2) % 3;
+    }
+
+    /// @brief Returns the index of the triangle of a half-edge.
+    static constexpr auto face(const index_type h) noexcept -> index_type {
+        return h / 3;
+    }
+
+    /// @brief Returns the oppositely oriented half-edge of the adjacent face.
+    /// @note Negative for half-edges on the boundary or non-manifold edges.
+    auto twin(const index_type h) const noexcept -> index_type {
+        assert(h >= 0 and h < half_edge_count());
+        return _twin[std_size(h)];
+    }
+
+    /// @brief Indicates if a half-edge lies on the boundary of the mesh.
+    auto is_boundary(const index_type h) const noexcept -> bool {
+        return twin(h) < 0;
+    }
+
+    /// @brief Returns the vertex where a half-edge starts.
+    auto origin(const index_type h) const noexcept -> unsigned {
+        assert(h >= 0 and h < half_edge_count());
+        return _origin[std_size(h)];
+    }
+
+    /// @brief Returns the vertex where a half-edge ends.
+    auto target(const index_type h) const noexcept -> unsigned {
+        return origin(next(h));
+    }
+
+    /// @brief Returns a half-edge going out of a vertex, or negative if none.
+    /// @note For boundary vertices this is the first one in the one-ring.
+    auto vertex_half_edge(const unsigned v) const noexcept -> index_type {
+        return v < _vertex_half_edge.size() ? _vertex_half_edge[v] : -1;
+    }
+
+    /// @brief Returns the range of the half-edges going out of a vertex.
+    /// @note On non-manifold vertices only one of the fans is traversed.
+    auto one_ring(const unsigned v) const noexcept -> one_ring_range {
+        return {*this, vertex_half_edge(v)};
+    }
+
+    /// @brief Returns the number of boundary loops.
+    auto boundary_loop_count() const noexcept -> span_size_t {
+        return span_size(_boundary_offsets.size()) - 1;
+    }
+
+    /// @brief Returns the consecutive half-edges of the i-th boundary loop.
+    auto boundary_loop(const span_size_t i) const noexcept
+      -> span<const index_type> {
+        assert(i >= 0 and i < boundary_loop_count());
+        const auto b{_boundary_offsets[std_size(i)]};
+        const auto e{_boundary_offsets[std_size(i + 1)]};
+        return head(skip(view(_boundary), b), e - b);
+    }
+
+    /// @brief Indicates if at most two consistently oriented faces share it.
+    auto is_manifold_edge(const index_type h) const noexcept -> bool {
+        assert(h >= 0 and h < half_edge_count());
+        return _non_manifold_edges.empty() or
+               not _non_manifold_edges[std_size(h)];
+    }
+
+    /// @brief Indicates if the faces around a vertex form a single fan.
+    auto is_manifold_vertex(const unsigned v) const noexcept -> bool {
+        return _non_manifold_vertices.empty() or
+               not _non_manifold_vertices[v];
+    }
+
+    /// @brief Indicates if all edges and vertices of the mesh are manifold.
+    auto is_manifold() const noexcept -> bool {
+        return _non_manifold_edges.empty() and _non_manifold_vertices.empty();
+    }
+
+private:
+    friend class topology;
+
+    std::vector<index_type> _twin;
+    std::vector<unsigned> _origin;
+    std::vector<index_type> _vertex_half_edge;
+    std::vector<index_type> _boundary;
+    std::vector<span_size_t> _boundary_offsets{0};
+    std::vector<std::uint8_t> _non_manifold_edges;
+    std::vector<std::uint8_t> _non_manifold_vertices;
+};
+//------------------------------------------------------------------------------
 /// @brief Class holding information about the topology of a generated shape.
 /// @ingroup shapes
 /// @see mesh_edge
 /// @see mesh_triangle
+///
+/// The per-triangle data is stored in separate contiguous arrays indexed
+/// by the triangle index, mesh_triangle and mesh_edge only provide access.
 export class topology : public main_ctx_object {
 public:
     /// @brief Construction from a shape generator and options.
@@ -227,30 +358,242 @@ public:
       const topology_options& opts,
       main_ctx_parent parent);
 
+    /// @brief Construction from a topology serialized by write_to.
+    /// @see write_to
+    /// @see is_loaded
+    ///
+    /// If the input is not valid or was computed from different generator
+    /// data or options, then the topology is computed from gen instead.
+    topology(
+      shared_holder<generator> gen,
+      const topology_options& opts,
+      std::istream& input,
+      main_ctx_parent parent);
+
+    /// @brief Construction from a topology persisted in a directory.
+    /// @see write_to
+    /// @see topology_source_hash
+    ///
+    /// The file name is derived from the source hash of gen and opts.
+    /// If the file does not exist or is not valid, the topology is computed
+    /// and then written into the file for reuse.
+    topology(
+      shared_holder<generator> gen,
+      const topology_options& opts,
+      const std::filesystem::path& directory,
+      main_ctx_parent parent);
+
+    /// @brief Indicates if the topology was read from serialized data.
+    auto is_loaded() const noexcept -> bool {
+        return _loaded;
+    }
+
+    /// @brief Writes the topology in a compact binary format into a stream.
+    /// @see topology_source_hash
+    ///
+    /// The data is stored with a versioned header and the source hash
+    /// and can be read back only on a platform with the same byte order.
+    auto write_to(std::ostream&) const -> std::ostream&;
+
     /// @brief Returns the number of triangles in the mesh.
     auto triangle_count() const noexcept -> span_size_t {
-        return span_size(_triangles.size());
+        return span_size(_indices.size() / 3U);
     }
 
     /// @brief Returns the i-th triangle in the mesh.
-    auto triangle(const span_size_t i) const noexcept -> const mesh_triangle& {
-        return _triangles[integer(i)];
+    auto triangle(const span_size_t i) const noexcept -> mesh_triangle {
+        assert(i >= 0 and i < triangle_count());
+        return {*this, std_size(i)};
+    }
+
+    /// @brief Returns the number of edges shared by two triangles.
+    auto edge_count() const noexcept -> span_size_t {
+        return span_size(_edges.size());
     }
 
+    /// @brief Returns the i-th edge shared by two triangles.
+    auto edge(const span_size_t i) const noexcept -> mesh_edge {
+        assert(i >= 0 and i < edge_count());
+        return {*this, std_size(i)};
+    }
+
+    /// @brief Returns the vertex indices of all triangles, three per triangle.
+    auto triangle_indices() const noexcept -> span<const std::uint32_t> {
+        return view(_indices);
+    }
+
+    /// @brief Returns the adjacent triangle indices, three per triangle.
+    /// @note Negative values indicate that there is no adjacent triangle.
+    auto adjacent_triangles() const noexcept -> span<const std::int32_t> {
+        return view(_adjacent);
+    }
+
+    /// @brief Returns the areas of all triangles.
+    /// @note Empty if the triangle area feature was not requested.
+    auto triangle_areas() const noexcept -> span<const float> {
+        return view(_areas);
+    }
+
+    /// @brief Returns the weights of all triangles.
+    /// @note Empty if the triangle weight feature was not requested.
+    auto triangle_weights() const noexcept -> span<const float> {
+        return view(_weights);
+    }
+
+    /// @brief Returns the half-edge representation of the mesh.
+    /// @note Empty if the half-edges feature was not requested.
+    auto half_edges() const noexcept -> const mesh_half_edges& {
+        return _half_edges;
+    }
+
+    /// @brief Returns the number of connected components of the mesh.
+    /// @note Zero if the connected components feature was not requested.
+    /// @see topology_feature_bit::connected_components
+    auto component_count() const noexcept -> span_size_t {
+        return span_size(_component_offsets.size()) - 1;
+    }
+
+    /// @brief Returns the connected component index of each triangle.
+    /// @note Empty if the connected components feature was not requested.
+    auto triangle_components() const noexcept -> span<const std::uint32_t> {
+        return view(_components);
+    }
+
+    /// @brief Returns the triangle indices ordered by the connected components.
+    /// @see component_triangle_range
+    auto component_order() const noexcept -> span<const std::uint32_t> {
+        return view(_component_order);
+    }
+
+    /// @brief Returns the first and count of the i-th component triangles.
+    /// @pre i >= 0 and i < component_count()
+    /// @see component_order
+    /// @see component_ordered_indices
+    auto component_triangle_range(const span_size_t i) const noexcept
+      -> std::tuple<span_size_t, span_size_t> {
+        assert(i >= 0 and i < component_count());
+        const auto b{_component_offsets[std_size(i)]};
+        const auto e{_component_offsets[std_size(i + 1)]};
+        return {span_size(b), span_size(e - b)};
+    }
+
+    /// @brief Returns the indices of triangles in the i-th connected component.
+    /// @pre i >= 0 and i < component_count()
+    auto component_triangles(const span_size_t i) const noexcept
+      -> span<const std::uint32_t> {
+        const auto [first, count] = component_triangle_range(i);
+        return head(skip(view(_component_order), first), count);
+    }
+
+    /// @brief Returns the bounding box of the i-th connected component.
+    /// @pre i >= 0 and i < component_count()
+    auto component_bounds(const span_size_t i) const noexcept
+      -> const shape_bounding_box& {
+        assert(i >= 0 and i < component_count());
+        return _component_bounds[std_size(i)];
+    }
+
+    /// @brief Returns the triangle vertex indices reordered by the components.
+    /// @see component_triangle_range
+    ///
+    /// The indices of the i-th component start at three times the first
+    /// triangle of its range, so each component can be drawn separately.
+    /// Without the connected components the original order is kept.
+    auto component_ordered_indices() const -> std::vector<std::uint32_t>;
+
     auto print_dot(std::ostream& out) const -> std::ostream&;
 
 private:
+    friend class mesh_triangle;
+    friend class mesh_edge;
+
     template <std::integral I>
     static auto to_index(const I i) noexcept -> unsigned {
         return limit_cast<unsigned>(i);
     }
 
     void _scan_topology(topology_options);
+    auto _read_from(std::istream&, const topology_options&) -> bool;
+    void _scan_adjacency(
+      topology_data&,
+      const bool with_half_edges,
+      const bool with_components);
+    void _scan_half_edges(
+      const topology_data&,
+      std::vector<std::uint8_t> non_manifold_edges);
+    void _scan_components(
+      const topology_data&,
+      std::vector<std::uint32_t> component_roots);
+
+    struct _edge_info {
+        std::array<std::uint32_t, 2> triangles;
+        std::array<std::uint8_t, 2> edge_begins;
+    };
 
     shared_holder<generator> _gen;
-    std::vector<mesh_triangle> _triangles;
-    flat_map<std::tuple<unsigned, unsigned>, mesh_edge> _edges;
+    topology_options _opts;
+    std::optional<std::uint64_t> _source_hash;
+    bool _loaded{false};
+    std::vector<std::uint32_t> _indices;
+    std::vector<std::int32_t> _adjacent;
+    std::vector<std::uint8_t> _opposite;
+    std::vector<float> _areas;
+    std::vector<float> _weights;
+    std::vector<_edge_info> _edges;
+    mesh_half_edges _half_edges;
+    std::vector<std::uint32_t> _components;
+    std::vector<std::uint32_t> _component_order;
+    std::vector<std::uint32_t> _component_offsets{0U};
+    std::vector<shape_bounding_box> _component_bounds;
 };
 //------------------------------------------------------------------------------
+inline auto mesh_edge::triangle(const span_size_t i) const noexcept
+  -> mesh_triangle {
+    assert(i >= 0 and i < 2);
+    return {*_topo, _topo->_edges[_edge_idx].triangles[integer(i)]};
+}
+//------------------------------------------------------------------------------
+inline auto mesh_edge::edge_vertices(const span_size_t i) const noexcept
+  -> std::tuple<unsigned, unsigned> {
+    assert(i >= 0 and i < 2);
+    const unsigned b{_topo->_edges[_edge_idx].edge_begins[integer(i)]};
+    return {b, (b + 1U) % 3U};
+}
+//------------------------------------------------------------------------------
+inline auto mesh_triangle::vertex_index(const span_size_t v) const noexcept
+  -> unsigned {
+    assert(v >= 0 and v < 3);
+    return _topo->_indices[_tri_idx * 3U + std_size(v)];
+}
+//------------------------------------------------------------------------------
+inline auto mesh_triangle::adjacent_triangle(const span_size_t v) const noexcept
+  -> std::optional<mesh_triangle> {
+    assert(v >= 0 and v < 3);
+    if(_topo->_adjacent.empty()) {
+        return {};
+    }
+    const auto adj{_topo->_adjacent[_tri_idx * 3U + std_size(v)]};
+    if(adj < 0) {
+        return {};
+    }
+    return {mesh_triangle{*_topo, std_size(adj)}};
+}
+//------------------------------------------------------------------------------
+inline auto mesh_triangle::opposite_vertex(const span_size_t v) const noexcept
+  -> unsigned {
+    assert(v >= 0 and v < 3);
+    if(_topo->_opposite.empty()) {
+        return 0U;
+    }
+    return _topo->_opposite[_tri_idx * 3U + std_size(v)];
+}
+//------------------------------------------------------------------------------
+inline auto mesh_triangle::area() const noexcept -> float {
+    return _topo->_areas.empty() ? 1.F : _topo->_areas[_tri_idx];
+}
+//------------------------------------------------------------------------------
+inline auto mesh_triangle::weight() const noexcept -> float {
+    return _topo->_weights.empty() ? 1.F : _topo->_weights[_tri_idx];
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
-
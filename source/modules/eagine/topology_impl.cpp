@@ -8,6 +8,12 @@
 module;
 
 #include <cassert>
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#define EAGINE_SHAPES_HAS_GETPID 1
+#else
+#define EAGINE_SHAPES_HAS_GETPID 0
+#endif
 
 module eagine.shapes;
 
@@ -19,15 +25,22 @@ namespace eagine::shapes {
 struct topology_data {
     unsigned coords_per_vertex{0U};
     unsigned weights_per_vertex{0U};
-    std::vector<float> vertex_positions;
-    std::vector<float> vertex_weights;
-    std::vector<unsigned> indices;
-    std::vector<draw_operation> operations;
+    shared_data_view<float> vertex_positions;
+    shared_data_view<float> vertex_weights;
+    shared_data_view<std::uint32_t> indices;
+    shared_data_view<draw_operation> operations;
+    std::vector<unsigned> welded_vertices;
+
+    auto vertex_count() const noexcept -> unsigned {
+        assert(coords_per_vertex > 0);
+        return limit_cast<unsigned>(
+          vertex_positions.size() / coords_per_vertex);
+    }
 
     auto values_of(const unsigned i) const noexcept {
         assert(coords_per_vertex > 0);
         return head(
-          skip(view(vertex_positions), span_size(coords_per_vertex * i)),
+          skip(vertex_positions.values(), span_size(coords_per_vertex * i)),
           span_size(coords_per_vertex));
     }
 
@@ -39,10 +52,11 @@ struct topology_data {
         return to_vec(values_of(i));
     }
 
-    auto distance_delta(const mesh_triangle& tri) const noexcept -> float {
-        const auto a = vec_of(tri.vertex_index(0));
-        const auto b = vec_of(tri.vertex_index(1));
-        const auto c = vec_of(tri.vertex_index(2));
+    auto distance_delta(const span<const std::uint32_t> tri) const noexcept
+      -> float {
+        const auto a = vec_of(tri[0]);
+        const auto b = vec_of(tri[1]);
+        const auto c = vec_of(tri[2]);
         return 0.1F *
                std::min(
                  std::min(distance(a, b), distance(b, c)), distance(a, c));
@@ -57,73 +71,381 @@ struct topology_data {
         return distance(p, q) < delta;
     }
 
-    auto is_same_vertex(unsigned i, unsigned j, float delta) const noexcept
-      -> bool {
-        return (i == j) or have_same_position(i, j, delta);
+    auto welded(const unsigned i) const noexcept -> unsigned {
+        return i < welded_vertices.size() ? welded_vertices[i] : i;
+    }
+
+    void weld_vertices(const span<const std::uint32_t> triangle_indices);
+
+private:
+    auto _weld_root(unsigned i) noexcept -> unsigned {
+        while(welded_vertices[i] != i) {
+            welded_vertices[i] = welded_vertices[welded_vertices[i]];
+            i = welded_vertices[i];
+        }
+        return i;
     }
 };
 //------------------------------------------------------------------------------
-auto mesh_triangle::setup_adjacent(
-  mesh_triangle& r,
-  const topology_data& topo) noexcept
-  -> std::tuple<bool, std::uint8_t, std::uint8_t, std::uint8_t, std::uint8_t> {
-    auto& l = *this;
-    assert(l.index() != r.index());
-    const auto delta = topo.distance_delta(l);
-    for(const auto i : integer_range(std_size(3))) {
-        for(const auto j : integer_range(std_size(3))) {
-            if(topo.is_same_vertex(l.curri(i), r.curri(j), delta)) {
-                if(topo.is_same_vertex(l.previ(i), r.previ(j), delta)) {
-                    l._adjacent[prevv(i)] = &r;
-                    l._opposite[prevv(i)] = narrow(nextv(j));
-                    r._adjacent[prevv(j)] = &l;
-                    r._opposite[prevv(j)] = narrow(nextv(i));
-                    return {
-                      true,
-                      narrow(prevv(i)),
-                      narrow(i),
-                      narrow(prevv(j)),
-                      narrow(j)};
-                } else if(topo.is_same_vertex(l.previ(i), r.nexti(j), delta)) {
-                    l._adjacent[prevv(i)] = &r;
-                    l._opposite[prevv(i)] = narrow(prevv(j));
-                    r._adjacent[j] = &l;
-                    r._opposite[j] = narrow(nextv(i));
-                    return {
-                      true,
-                      narrow(prevv(i)),
-                      narrow(i),
-                      narrow(j),
-                      narrow(nextv(j))};
-                } else if(topo.is_same_vertex(l.nexti(i), r.previ(j), delta)) {
-                    l._adjacent[i] = &r;
-                    l._opposite[i] = narrow(nextv(j));
-                    r._adjacent[prevv(j)] = &l;
-                    r._opposite[prevv(j)] = narrow(prevv(i));
-                    return {
-                      true,
-                      narrow(i),
-                      narrow(nextv(i)),
-                      narrow(prevv(j)),
-                      narrow(j)};
-                } else if(topo.is_same_vertex(l.nexti(i), r.nexti(j), delta)) {
-                    l._adjacent[i] = &r;
-                    l._opposite[i] = narrow(prevv(j));
-                    r._adjacent[j] = &l;
-                    r._opposite[j] = narrow(prevv(i));
-                    return {
-                      true,
-                      narrow(i),
-                      narrow(nextv(i)),
-                      narrow(j),
-                      narrow(nextv(j))};
+// Maps each vertex to the lowest vertex index with the same position.
+// Vertices are quantized into a grid with cells as large as the biggest
+// welding tolerance, so only vertices in neighboring cells must be compared.
+void topology_data::weld_vertices(
+  const span<const std::uint32_t> triangle_indices) {
+    const auto vc = vertex_count();
+    welded_vertices.resize(vc);
+    std::iota(welded_vertices.begin(), welded_vertices.end(), 0U);
+
+    std::vector<float> tolerances(vc, std::numeric_limits<float>::infinity());
+    for(span_size_t t = 0; t < triangle_indices.size(); t += 3) {
+        const auto tri{head(skip(triangle_indices, t), 3)};
+        const auto delta = distance_delta(tri);
+        for(const auto v : integer_range(3)) {
+            auto& tolerance = tolerances[tri[v]];
+            tolerance = std::min(tolerance, delta);
+        }
+    }
+
+    float cell_size{0.F};
+    for(const auto tolerance : tolerances) {
+        if(std::isfinite(tolerance)) {
+            cell_size = std::max(cell_size, tolerance);
+        }
+    }
+    if(not(cell_size > 0.F)) {
+        return;
+    }
+
+    using cell_key = std::tuple<std::int64_t, std::int64_t, std::int64_t>;
+    // the cell coordinates are kept away from the limits of the integer
+    // type, so that the conversion and the neighbor offsets do not overflow
+    const auto cell_coord{
+      [cell_size](const float c) -> std::optional<std::int64_t> {
+          const auto q{std::floor(c / cell_size)};
+          const float limit{std::ldexp(1.F, 62)};
+          if(std::isfinite(q) and (std::abs(q) < limit)) {
+              return static_cast<std::int64_t>(q);
+          }
+          return {};
+      }};
+
+    std::vector<std::tuple<cell_key, unsigned>> cells;
+    cells.reserve(vc);
+    for(const auto i : integer_range(vc)) {
+        if((tolerances[i] > 0.F) and std::isfinite(tolerances[i])) {
+            const auto p = values_of(i);
+            const auto cx{cell_coord(p[0])};
+            const auto cy{cell_coord(p[1])};
+            const auto cz{cell_coord(p[2])};
+            // vertices with non-representable cells are not welded
+            if(cx and cy and cz) {
+                cells.emplace_back(cell_key{*cx, *cy, *cz}, i);
+            }
+        }
+    }
+    std::sort(cells.begin(), cells.end());
+
+    for(const auto& [key, i] : cells) {
+        const auto [cx, cy, cz] = key;
+        for(const auto dx : integer_range(-1, 2)) {
+            for(const auto dy : integer_range(-1, 2)) {
+                for(const auto dz : integer_range(-1, 2)) {
+                    const cell_key nkey{cx + dx, cy + dy, cz + dz};
+                    auto pos = std::lower_bound(
+                      cells.begin(), cells.end(), std::make_tuple(nkey, 0U));
+                    for(; pos != cells.end() and std::get<0>(*pos) == nkey;
+                        ++pos) {
+                        const auto j = std::get<1>(*pos);
+                        if(i < j) {
+                            const auto delta =
+                              std::min(tolerances[i], tolerances[j]);
+                            if(have_same_position(i, j, delta)) {
+                                const auto ri = _weld_root(i);
+                                const auto rj = _weld_root(j);
+                                if(ri != rj) {
+                                    welded_vertices[std::max(ri, rj)] =
+                                      std::min(ri, rj);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for(const auto i : integer_range(vc)) {
+        welded_vertices[i] = _weld_root(i);
+    }
+}
+//------------------------------------------------------------------------------
+// Runs count tasks on the workers and on the calling thread, which also
+// reports the number of finished tasks through on_progress.
+template <typename Workers, typename Task, typename Progress>
+static void run_topology_tasks(
+  Workers& workers,
+  const std::size_t count,
+  const Task& task,
+  const Progress& on_progress) {
+    std::atomic<std::size_t> next_task{0U};
+    std::atomic<std::size_t> done_tasks{0U};
+    const auto make_worker{[&](const bool report) {
+        return [&, report]() -> bool {
+            for(auto t{next_task++}; t < count; t = next_task++) {
+                task(t);
+                const auto done{++done_tasks};
+                if(report) {
+                    on_progress(done);
                 }
             }
+            return true;
+        };
+    }};
+    if(count > 1U) {
+        const inplace_work_batch batch{workers, make_worker(false)};
+        make_worker(true)();
+    } else {
+        make_worker(true)();
+    }
+}
+
+template <typename Workers, typename Task>
+static void run_topology_tasks(
+  Workers& workers,
+  const std::size_t count,
+  const Task& task) {
+    run_topology_tasks(workers, count, task, [](std::size_t) {});
+}
+//------------------------------------------------------------------------------
+// Sorts chunks of the elements in parallel and then merges pairs
+// of the sorted neighboring chunks, also in parallel, until one is left.
+template <typename Workers, typename T>
+static void parallel_topology_sort(Workers& workers, std::vector<T>& elements) {
+    const std::size_t min_chunk_size{1U << 14U};
+    const std::size_t chunk_count{
+      std::min(elements.size() / min_chunk_size, std::size_t(64U))};
+    if(chunk_count < 2U) {
+        std::sort(elements.begin(), elements.end());
+        return;
+    }
+
+    const auto bound{[&](const std::size_t c) {
+        return elements.begin() +
+               std::ptrdiff_t(std::min(c, chunk_count) * elements.size() /
+                              chunk_count);
+    }};
+
+    run_topology_tasks(workers, chunk_count, [&](const std::size_t c) {
+        std::sort(bound(c), bound(c + 1U));
+    });
+
+    for(std::size_t width{1U}; width < chunk_count; width *= 2U) {
+        const auto merge_count{(chunk_count + 2U * width - 1U) / (2U * width)};
+        run_topology_tasks(workers, merge_count, [&](const std::size_t m) {
+            const auto first{m * 2U * width};
+            const auto middle{first + width};
+            if(middle < chunk_count) {
+                std::inplace_merge(
+                  bound(first), bound(middle), bound(middle + width));
+            }
+        });
+    }
+}
+//------------------------------------------------------------------------------
+// Appends the vertex indices of triangles from the [begin, end) range
+// of vertices processed by the draw operation.
+static void extract_topology_triangles(
+  const topology_data& data,
+  const draw_operation& operation,
+  const span_size_t begin,
+  const span_size_t end,
+  std::vector<std::uint32_t>& dest) {
+    const bool indexed = operation.idx_type != index_data_type::none;
+    span_size_t i{begin};
+
+    const auto is_pri{[&]() {
+        return indexed and data.indices[i] == operation.primitive_restart_index;
+    }};
+
+    const auto add_triangle{[&](int a, int b, int c) {
+        for(const auto o : {a, b, c}) {
+            dest.push_back(
+              indexed ? data.indices[integer(operation.first + i + o)]
+                      : limit_cast<std::uint32_t>(operation.first + i + o));
+        }
+    }};
+
+    if(operation.mode == primitive_type::triangles) {
+        for(; i < end; i += 3) {
+            if(operation.cw_face_winding) {
+                add_triangle(0, 1, 2);
+            } else {
+                add_triangle(0, 2, 1);
+            }
+        }
+    } else if(operation.mode == primitive_type::triangle_strip) {
+        for(; i < end; i += 2) {
+            if(is_pri()) {
+                ++i;
+                continue;
+            }
+            if(operation.cw_face_winding) {
+                add_triangle(-2, -1, 0);
+                add_triangle(0, -1, 1);
+            } else {
+                add_triangle(-1, -2, 0);
+                add_triangle(-1, 0, 1);
+            }
+        }
+    }
+}
+//------------------------------------------------------------------------------
+// serialization
+//------------------------------------------------------------------------------
+static constexpr const std::array<char, 8> topology_blob_magic{
+  'E', 'A', 'G', 'T', 'O', 'P', 'O', '\0'};
+static constexpr const std::uint32_t topology_blob_version{3U};
+
+struct topology_blob_header {
+    std::uint32_t version{topology_blob_version};
+    // mask of the topology_feature_bit values
+    std::uint32_t features{0U};
+    std::uint64_t source_hash{0U};
+    std::uint64_t triangle_count{0U};
+    std::uint64_t vertex_count{0U};
+    std::uint64_t edge_count{0U};
+};
+//------------------------------------------------------------------------------
+static auto topology_feature_mask(const topology_feature_bits features) noexcept
+  -> std::uint32_t {
+    std::uint32_t mask{0U};
+    for(const auto bit :
+        {topology_feature_bit::triangle_adjacency,
+         topology_feature_bit::triangle_area,
+         topology_feature_bit::triangle_weight,
+         topology_feature_bit::edge_length,
+         topology_feature_bit::half_edges,
+         topology_feature_bit::connected_components}) {
+        if(features.has(bit)) {
+            mask |= std::uint32_t(bit);
         }
     }
-    return {false, 0U, 0U, 0U, 0U};
+    return mask;
+}
+//------------------------------------------------------------------------------
+static auto topology_effective_features(
+  generator& gen,
+  const topology_options& opts) -> topology_feature_bits {
+    auto features{opts.features};
+    if(gen.values_per_vertex(opts.weight_variant) < 1) {
+        features.clear(topology_feature_bit::triangle_weight);
+    }
+    return features;
+}
+//------------------------------------------------------------------------------
+static void topology_hash_bytes(
+  std::uint64_t& hash,
+  const void* data,
+  const std::size_t size) noexcept {
+    // FNV-1a
+    const auto* bytes{static_cast<const unsigned char*>(data)};
+    for(std::size_t i{0U}; i < size; ++i) {
+        hash ^= std::uint64_t(bytes[i]);
+        hash *= 0x100000001B3ULL;
+    }
+}
+
+static void topology_hash_values(
+  std::uint64_t& hash,
+  const auto values) noexcept {
+    const std::uint64_t count{std_size(values.size())};
+    topology_hash_bytes(hash, &count, sizeof(count));
+    topology_hash_bytes(
+      hash, values.data(), std_size(values.size()) * sizeof(*values.data()));
+}
+//------------------------------------------------------------------------------
+auto topology_source_hash(generator& gen, const topology_options& opts)
+  -> std::uint64_t {
+    const auto features{topology_effective_features(gen, opts)};
+    std::uint64_t hash{0xCBF29CE484222325ULL};
+    const auto add{[&](const auto value) {
+        topology_hash_bytes(hash, &value, sizeof(value));
+    }};
+
+    add(topology_blob_version);
+    add(topology_feature_mask(features));
+    add(std::int64_t(gen.values_per_vertex(opts.position_variant)));
+    topology_hash_values(
+      hash, shared_attrib_values<float>(gen, opts.position_variant).values());
+    if(features.has(topology_feature_bit::triangle_weight)) {
+        add(std::int64_t(gen.values_per_vertex(opts.weight_variant)));
+        topology_hash_values(
+          hash, shared_attrib_values<float>(gen, opts.weight_variant).values());
+    }
+
+    const drawing_variant var = gen.draw_variant(opts.draw_variant_index);
+    topology_hash_values(
+      hash, shared_indices<std::uint32_t>(gen, var).values());
+    const auto operations{shared_instructions(gen, var)};
+    for(const auto& operation : operations.values()) {
+        add(std::int64_t(operation.first));
+        add(std::int64_t(operation.count));
+        add(operation.primitive_restart_index);
+        add(std::uint32_t(operation.mode));
+        add(std::uint32_t(operation.idx_type));
+        add(std::uint8_t(operation.primitive_restart));
+        add(std::uint8_t(operation.cw_face_winding));
+    }
+    return hash;
+}
+//------------------------------------------------------------------------------
+template <typename T>
+static void write_topology_array(
+  std::ostream& out,
+  const std::vector<T>& values) {
+    const std::uint64_t size{values.size()};
+    out.write(
+      reinterpret_cast<const char*>(&size), std::streamsize(sizeof(size)));
+    out.write(
+      reinterpret_cast<const char*>(values.data()),
+      std::streamsize(values.size() * sizeof(T)));
+}
+
+template <typename T>
+static auto read_topology_array(
+  std::istream& inp,
+  std::vector<T>& values,
+  const std::uint64_t max_size) -> bool {
+    std::uint64_t size{0U};
+    if(not inp.read(
+         reinterpret_cast<char*>(&size), std::streamsize(sizeof(size)))) {
+        return false;
+    }
+    if(size > max_size) {
+        return false;
+    }
+    values.resize(std_size(size));
+    return bool(inp.read(
+      reinterpret_cast<char*>(values.data()),
+      std::streamsize(values.size() * sizeof(T))));
 }
 //------------------------------------------------------------------------------
+// The temporary file name must be unique across processes and threads
+// that can store the same topology at the same time.
+static auto topology_temp_suffix() -> std::string {
+#if EAGINE_SHAPES_HAS_GETPID
+    const auto process_id{std::uint64_t(::getpid())};
+#else
+    const auto process_id{std::uint64_t(std::random_device{}())};
+#endif
+    return std::format(
+      ".{}.{:x}.tmp",
+      process_id,
+      std::hash<std::thread::id>{}(std::this_thread::get_id()));
+}
+//------------------------------------------------------------------------------
+// topology
+//------------------------------------------------------------------------------
 topology::topology(
   shared_holder<generator> gen,
   const topology_options& opts,
@@ -133,25 +455,272 @@ topology::topology(
     _scan_topology(opts);
 }
 //------------------------------------------------------------------------------
+topology::topology(
+  shared_holder<generator> gen,
+  const topology_options& opts,
+  std::istream& input,
+  main_ctx_parent parent)
+  : main_ctx_object{"ShpTopolgy", parent}
+  , _gen{std::move(gen)}
+  , _source_hash{topology_source_hash(*_gen, opts)} {
+    if(_read_from(input, opts)) {
+        log_debug("using serialized shape topology")
+          .arg("triangles", triangle_count());
+        return;
+    }
+    log_debug("serialized shape topology not usable, computing it");
+    _scan_topology(opts);
+}
+//------------------------------------------------------------------------------
+topology::topology(
+  shared_holder<generator> gen,
+  const topology_options& opts,
+  const std::filesystem::path& directory,
+  main_ctx_parent parent)
+  : main_ctx_object{"ShpTopolgy", parent}
+  , _gen{std::move(gen)}
+  , _source_hash{topology_source_hash(*_gen, opts)} {
+    const auto path{
+      directory / std::format("{:016x}.eagtopo", _source_hash.value())};
+    if(std::ifstream input{path, std::ios::binary}) {
+        if(_read_from(input, opts)) {
+            log_debug("using persisted shape topology")
+              .arg("path", path.string())
+              .arg("triangles", triangle_count());
+            return;
+        }
+    }
+    _scan_topology(opts);
+
+    // the file is written under a temporary name and then renamed,
+    // so that concurrent readers never see partially written data
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    auto temp_path{path};
+    temp_path += topology_temp_suffix();
+    bool written{false};
+    {
+        std::ofstream output{temp_path, std::ios::binary | std::ios::trunc};
+        written = output and write_to(output);
+    }
+    if(written) {
+        std::filesystem::rename(temp_path, path, error);
+        written = not error;
+    }
+    if(written) {
+        log_info("persisted shape topology")
+          .arg("path", path.string())
+          .arg("triangles", triangle_count());
+    } else {
+        std::filesystem::remove(temp_path, error);
+        log_warning("failed to persist shape topology")
+          .arg("path", path.string());
+    }
+}
+//------------------------------------------------------------------------------
+auto topology::write_to(std::ostream& out) const -> std::ostream& {
+    auto gen{_gen};
+    topology_blob_header header;
+    header.features = topology_feature_mask(_opts.features);
+    header.source_hash =
+      _source_hash ? *_source_hash : topology_source_hash(*gen, _opts);
+    header.triangle_count = _indices.size() / 3U;
+    header.vertex_count = limit_cast<std::uint64_t>(gen->vertex_count());
+    header.edge_count = _edges.size();
+
+    // the edges are stored as the pair of triangles and packed edge begins
+    std::vector<std::uint32_t> edges;
+    edges.reserve(_edges.size() * 3U);
+    for(const auto& edge : _edges) {
+        edges.push_back(edge.triangles[0]);
+        edges.push_back(edge.triangles[1]);
+        edges.push_back(
+          std::uint32_t(edge.edge_begins[0]) |
+          (std::uint32_t(edge.edge_begins[1]) << 8U));
+    }
+    std::vector<std::int64_t> boundary_offsets;
+    for(const auto offset : _half_edges._boundary_offsets) {
+        boundary_offsets.push_back(offset);
+    }
+
+    out.write(topology_blob_magic.data(), topology_blob_magic.size());
+    out.write(
+      reinterpret_cast<const char*>(&header), std::streamsize(sizeof(header)));
+    write_topology_array(out, _indices);
+    write_topology_array(out, _adjacent);
+    write_topology_array(out, _opposite);
+    write_topology_array(out, _areas);
+    write_topology_array(out, _weights);
+    write_topology_array(out, edges);
+    write_topology_array(out, _half_edges._twin);
+    write_topology_array(out, _half_edges._origin);
+    write_topology_array(out, _half_edges._vertex_half_edge);
+    write_topology_array(out, _half_edges._boundary);
+    write_topology_array(out, boundary_offsets);
+    write_topology_array(out, _half_edges._non_manifold_edges);
+    write_topology_array(out, _half_edges._non_manifold_vertices);
+    write_topology_array(out, _components);
+    write_topology_array(out, _component_order);
+    write_topology_array(out, _component_offsets);
+    write_topology_array(out, _component_bounds);
+    return out;
+}
+//------------------------------------------------------------------------------
+auto topology::_read_from(std::istream& inp, const topology_options& opts)
+  -> bool {
+    assert(_source_hash);
+    _opts = opts;
+    _opts.features = topology_effective_features(*_gen, opts);
+
+    std::array<char, 8> magic{};
+    topology_blob_header header;
+    if(not inp.read(magic.data(), magic.size())) {
+        return false;
+    }
+    if(magic != topology_blob_magic) {
+        return false;
+    }
+    if(not inp.read(
+         reinterpret_cast<char*>(&header), std::streamsize(sizeof(header)))) {
+        return false;
+    }
+    if(
+      (header.version != topology_blob_version) or
+      (header.source_hash != *_source_hash) or
+      (header.features != topology_feature_mask(_opts.features)) or
+      (header.vertex_count !=
+       limit_cast<std::uint64_t>(_gen->vertex_count()))) {
+        return false;
+    }
+    const auto tc{header.triangle_count};
+    const auto vc{header.vertex_count};
+    const auto ec{header.edge_count};
+    const std::uint64_t max_count{std::numeric_limits<std::int32_t>::max() / 3};
+    if((tc > max_count) or (ec > max_count)) {
+        return false;
+    }
+    const auto hec{tc * 3U};
+
+    auto& mesh = _half_edges;
+    std::vector<std::uint32_t> edges;
+    std::vector<std::int64_t> boundary_offsets;
+    const bool read =
+      read_topology_array(inp, _indices, hec) and
+      read_topology_array(inp, _adjacent, hec) and
+      read_topology_array(inp, _opposite, hec) and
+      read_topology_array(inp, _areas, tc) and
+      read_topology_array(inp, _weights, tc) and
+      read_topology_array(inp, edges, ec * 3U) and
+      read_topology_array(inp, mesh._twin, hec) and
+      read_topology_array(inp, mesh._origin, hec) and
+      read_topology_array(inp, mesh._vertex_half_edge, vc) and
+      read_topology_array(inp, mesh._boundary, hec) and
+      read_topology_array(inp, boundary_offsets, hec + 1U) and
+      read_topology_array(inp, mesh._non_manifold_edges, hec) and
+      read_topology_array(inp, mesh._non_manifold_vertices, vc) and
+      read_topology_array(inp, _components, tc) and
+      read_topology_array(inp, _component_order, tc) and
+      read_topology_array(inp, _component_offsets, tc + 1U) and
+      read_topology_array(inp, _component_bounds, tc);
+
+    // the data must be consistent, so that the accessors stay in bounds
+    const auto sized{[](const auto& values, const std::uint64_t size) {
+        return values.empty() or (values.size() == size);
+    }};
+    const auto within{[](
+                        const auto& values,
+                        const std::int64_t min,
+                        const std::uint64_t max) {
+        return std::all_of(values.begin(), values.end(), [=](const auto v) {
+            return (std::int64_t(v) >= min) and
+                   (std::int64_t(v) < std::int64_t(max));
+        });
+    }};
+    const bool valid =
+      read and (_indices.size() == hec) and sized(_adjacent, hec) and
+      (_opposite.size() == _adjacent.size()) and sized(_areas, tc) and
+      sized(_weights, tc) and (edges.size() == ec * 3U) and
+      sized(mesh._twin, hec) and (mesh._origin.size() == mesh._twin.size()) and
+      sized(mesh._vertex_half_edge, vc) and
+      sized(mesh._non_manifold_edges, hec) and
+      sized(mesh._non_manifold_vertices, vc) and
+      not boundary_offsets.empty() and (boundary_offsets.front() == 0) and
+      (std::uint64_t(boundary_offsets.back()) == mesh._boundary.size()) and
+      std::is_sorted(boundary_offsets.begin(), boundary_offsets.end()) and
+      within(_indices, 0, vc) and within(_adjacent, -1, tc) and
+      within(_opposite, 0, 3U) and within(mesh._twin, -1, hec) and
+      within(mesh._origin, 0, vc) and
+      within(mesh._vertex_half_edge, -1, hec) and
+      within(mesh._boundary, 0, hec) and
+      sized(_components, tc) and
+      (_component_order.size() == _components.size()) and
+      not _component_offsets.empty() and (_component_offsets.front() == 0U) and
+      (_component_offsets.back() == _component_order.size()) and
+      std::is_sorted(_component_offsets.begin(), _component_offsets.end()) and
+      (_component_bounds.size() + 1U == _component_offsets.size()) and
+      within(_components, 0, _component_bounds.size()) and
+      within(_component_order, 0, tc);
+
+    if(valid) {
+        _edges.clear();
+        _edges.reserve(edges.size() / 3U);
+        for(std::size_t e{0U}; e < edges.size(); e += 3U) {
+            const auto lbegin{edges[e + 2U] & 0xFFU};
+            const auto rbegin{edges[e + 2U] >> 8U};
+            if(
+              (edges[e] >= tc) or (edges[e + 1U] >= tc) or (lbegin >= 3U) or
+              (rbegin >= 3U)) {
+                break;
+            }
+            _edges.push_back(
+              {{edges[e], edges[e + 1U]},
+               {limit_cast<std::uint8_t>(lbegin),
+                limit_cast<std::uint8_t>(rbegin)}});
+        }
+        mesh._boundary_offsets.clear();
+        for(const auto offset : boundary_offsets) {
+            mesh._boundary_offsets.push_back(limit_cast<span_size_t>(offset));
+        }
+    }
+
+    if(not valid or (_edges.size() * 3U != edges.size())) {
+        _indices.clear();
+        _adjacent.clear();
+        _opposite.clear();
+        _areas.clear();
+        _weights.clear();
+        _edges.clear();
+        _half_edges = {};
+        _components.clear();
+        _component_order.clear();
+        _component_offsets.assign(1U, 0U);
+        _component_bounds.clear();
+        return false;
+    }
+    _loaded = true;
+    return true;
+}
+//------------------------------------------------------------------------------
 auto topology::print_dot(std::ostream& out) const -> std::ostream& {
     out << "graph MeshTopology {\n";
     out << "overlap=voronoi;\n";
     out << "node [shape=triangle];\n";
 
-    for(const auto& tri : _triangles) {
-        const auto i = tri.index();
+    for(const auto i : integer_range(triangle_count())) {
         out << "t" << i << " [label=\"" << i << "\"];\n";
     }
 
     out << "node [shape=point];\n";
-    for(const auto& [idxt, edg] : _edges) {
-        auto [lidx, ridx] = idxt;
+    for(const auto e : integer_range(edge_count())) {
+        const auto edg{edge(e)};
+        const auto lidx{edg.triangle(0).index()};
+        const auto ridx{edg.triangle(1).index()};
 
         out << "et" << lidx << "t" << ridx << ";\n";
 
         for(const auto t : integer_range(std_size(2))) {
             auto [bi, ei] = edg.edge_vertices(signedness_cast(t));
-            auto& tri = edg.triangle(signedness_cast(t));
+            const auto tri{edg.triangle(signedness_cast(t))};
             out << "et" << lidx << "t" << ridx << " -- "
                 << "t" << tri.index() << "[label=\"<" << bi << "," << ei
                 << ">\\n[" << tri.vertex_index(bi) << ","
@@ -169,134 +738,435 @@ void topology::_scan_topology(topology_options opts) {
 
     data.coords_per_vertex =
       limit_cast<unsigned>(_gen->values_per_vertex(opts.position_variant));
-    data.vertex_positions.resize(
-      integer(_gen->value_count(opts.position_variant)));
-    _gen->attrib_values(opts.position_variant, cover(data.vertex_positions));
+    data.vertex_positions =
+      shared_attrib_values<float>(*_gen, opts.position_variant);
 
-    if(_gen->values_per_vertex(opts.weight_variant) < 1) {
-        opts.features.clear(topology_feature_bit::triangle_weight);
-    }
+    opts.features = topology_effective_features(*_gen, opts);
+    _opts = opts;
 
     if(opts.features.has(topology_feature_bit::triangle_weight)) {
         data.weights_per_vertex =
           limit_cast<unsigned>(_gen->values_per_vertex(opts.weight_variant));
-        data.vertex_weights.resize(
-          integer(_gen->value_count(opts.weight_variant)));
-        _gen->attrib_values(opts.weight_variant, cover(data.vertex_weights));
+        data.vertex_weights =
+          shared_attrib_values<float>(*_gen, opts.weight_variant);
+    }
+
+    data.indices = shared_indices<std::uint32_t>(*_gen, var);
+    data.operations = shared_instructions(*_gen, var);
+
+    // the draw operations are split into ranges of vertices, with
+    // independent triangle lists, the strips are not split because
+    // of the primitive restarts
+    const span_size_t chunk_size{3 * (1 << 15)};
+    std::vector<std::tuple<std::size_t, span_size_t, span_size_t>> chunks;
+    for(const auto o : integer_range(std_size(data.operations.size()))) {
+        const auto& operation = data.operations[o];
+        if(operation.mode == primitive_type::triangles) {
+            for(span_size_t b = 0; b < operation.count; b += chunk_size) {
+                chunks.emplace_back(
+                  o, b, math::minimum(b + chunk_size, operation.count));
+            }
+        } else if(operation.mode == primitive_type::triangle_strip) {
+            chunks.emplace_back(o, 2, operation.count);
+        }
     }
 
-    data.indices.resize(integer(_gen->index_count(var)));
-    _gen->indices(var, cover(data.indices));
+    std::vector<std::vector<std::uint32_t>> chunk_indices(chunks.size());
+    {
+        const auto scan_ops = progress().activity(
+          "processing shape draw operations", integer(chunks.size()));
+        run_topology_tasks(
+          workers(),
+          chunks.size(),
+          [&](const std::size_t c) {
+              const auto [o, begin, end] = chunks[c];
+              extract_topology_triangles(
+                data, data.operations[o], begin, end, chunk_indices[c]);
+          },
+          [&](const std::size_t done) {
+              scan_ops.update_progress(integer(done));
+          });
+    }
 
-    data.operations.resize(integer(_gen->operation_count(var)));
-    _gen->instructions(var, cover(data.operations));
+    std::vector<std::size_t> offsets;
+    offsets.reserve(chunk_indices.size() + 1U);
+    offsets.push_back(0U);
+    for(const auto& indices : chunk_indices) {
+        offsets.push_back(offsets.back() + indices.size());
+    }
+    _indices.resize(offsets.back());
+    run_topology_tasks(workers(), chunk_indices.size(), [&](std::size_t c) {
+        std::copy(
+          chunk_indices[c].begin(),
+          chunk_indices[c].end(),
+          _indices.begin() + std::ptrdiff_t(offsets[c]));
+        chunk_indices[c] = {};
+    });
 
-    auto scan_ops = progress().activity(
-      "processing shape draw operations", integer(data.operations.size()));
+    const bool has_areas{
+      opts.features.has(topology_feature_bit::triangle_area)};
+    const bool has_weights{
+      opts.features.has(topology_feature_bit::triangle_weight)};
+    if(has_areas or has_weights) {
+        const auto tri_count{std_size(triangle_count())};
+        if(has_areas) {
+            assert(data.coords_per_vertex >= 3U);
+            _areas.resize(tri_count);
+        }
+        if(has_weights) {
+            assert(data.weights_per_vertex >= 1U);
+            _weights.resize(tri_count);
+        }
+        const std::size_t tri_chunk{1U << 15U};
+        run_topology_tasks(
+          workers(),
+          (tri_count + tri_chunk - 1U) / tri_chunk,
+          [&](const std::size_t c) {
+              const auto end{std::min((c + 1U) * tri_chunk, tri_count)};
+              for(auto t{c * tri_chunk}; t < end; ++t) {
+                  const auto ia = _indices[t * 3U + 0U];
+                  const auto ib = _indices[t * 3U + 1U];
+                  const auto ic = _indices[t * 3U + 2U];
+                  if(has_areas) {
+                      const auto vpv = data.coords_per_vertex;
+                      const auto& pos = data.vertex_positions;
+                      _areas[t] =
+                        math::triangle<float>{
+                          math::point<float, 3>{
+                            pos[ia * vpv + 0],
+                            pos[ia * vpv + 1],
+                            pos[ia * vpv + 2]},
+                          math::point<float, 3>{
+                            pos[ib * vpv + 0],
+                            pos[ib * vpv + 1],
+                            pos[ib * vpv + 2]},
+                          math::point<float, 3>{
+                            pos[ic * vpv + 0],
+                            pos[ic * vpv + 1],
+                            pos[ic * vpv + 2]}}
+                          .area();
+                  }
+                  if(has_weights) {
+                      const auto vpv = data.weights_per_vertex;
+                      const auto& wgt = data.vertex_weights;
+                      _weights[t] =
+                        wgt[ia * vpv] + wgt[ib * vpv] + wgt[ic * vpv];
+                  }
+              }
+          });
+    }
 
-    for(auto& operation : data.operations) {
-        const bool indexed = operation.idx_type != index_data_type::none;
-        span_size_t i;
+    const bool with_half_edges{
+      opts.features.has(topology_feature_bit::half_edges)};
+    const bool with_components{
+      opts.features.has(topology_feature_bit::connected_components)};
+    if(
+      with_half_edges or with_components or
+      opts.features.has(topology_feature_bit::triangle_adjacency)) {
+        _scan_adjacency(data, with_half_edges, with_components);
+    }
+}
+//------------------------------------------------------------------------------
+// Finds the union-find root of a triangle, halving the path to it.
+static auto topology_component_root(
+  std::vector<std::uint32_t>& roots,
+  std::uint32_t t) noexcept -> std::uint32_t {
+    while(roots[t] != t) {
+        roots[t] = roots[roots[t]];
+        t = roots[t];
+    }
+    return t;
+}
+//------------------------------------------------------------------------------
+// Triangle edges are keyed by the pair of welded vertex indices, sorted
+// and then the triangles sharing the same key are linked together.
+void topology::_scan_adjacency(
+  topology_data& data,
+  const bool with_half_edges,
+  const bool with_components) {
+    data.weld_vertices(view(_indices));
 
-        const auto is_pri{[&]() {
-            return indexed and
-                   data.indices[i] == operation.primitive_restart_index;
-        }};
+    using edge_key = std::tuple<unsigned, unsigned, unsigned, std::uint8_t>;
+    const auto tri_count{std_size(triangle_count())};
+    const std::size_t tri_chunk{1U << 15U};
+    const auto chunk_count{(tri_count + tri_chunk - 1U) / tri_chunk};
 
-        const auto add_triangle{[&](int a, int b, int c) {
-            if(indexed) {
-                _triangles.emplace_back(
-                  _triangles.size(),
-                  data.indices[integer(operation.first + i + a)],
-                  data.indices[integer(operation.first + i + b)],
-                  data.indices[integer(operation.first + i + c)]);
-            } else {
-                _triangles.emplace_back(
-                  _triangles.size(),
-                  to_index(operation.first + i + a),
-                  to_index(operation.first + i + b),
-                  to_index(operation.first + i + c));
-            }
+    // each chunk of triangles collects its edges separately
+    std::vector<std::vector<edge_key>> chunk_edges(chunk_count);
+    {
+        const auto scan_tris = progress().activity(
+          "processing shape triangles", integer(chunk_count));
+        run_topology_tasks(
+          workers(),
+          chunk_count,
+          [&](const std::size_t c) {
+              auto& dest = chunk_edges[c];
+              const auto end{std::min((c + 1U) * tri_chunk, tri_count)};
+              dest.reserve((end - c * tri_chunk) * 3U);
+              for(auto t{c * tri_chunk}; t < end; ++t) {
+                  for(const auto e : integer_range(std_size(3))) {
+                      const auto a = data.welded(_indices[t * 3U + e]);
+                      const auto b =
+                        data.welded(_indices[t * 3U + (e + 1U) % 3U]);
+                      if(a != b) {
+                          dest.emplace_back(
+                            std::min(a, b),
+                            std::max(a, b),
+                            to_index(t),
+                            limit_cast<std::uint8_t>(e));
+                      }
+                  }
+              }
+          },
+          [&](const std::size_t done) {
+              scan_tris.update_progress(integer(done));
+          });
+    }
 
-            auto& tri = _triangles.back();
-            if(opts.features.has(topology_feature_bit::triangle_area)) {
-                assert(data.coords_per_vertex >= 3U);
-                const auto vpv = data.coords_per_vertex;
-                const auto& pos = data.vertex_positions;
-                const auto ia = tri.vertex_index(0);
-                const auto ib = tri.vertex_index(1);
-                const auto ic = tri.vertex_index(2);
-                tri.set_area(math::triangle<float>{
-                  math::point<float, 3>{
-                    pos[ia * vpv + 0], pos[ia * vpv + 1], pos[ia * vpv + 2]},
-                  math::point<float, 3>{
-                    pos[ib * vpv + 0], pos[ib * vpv + 1], pos[ib * vpv + 2]},
-                  math::point<float, 3>{
-                    pos[ic * vpv + 0], pos[ic * vpv + 1], pos[ic * vpv + 2]}}
-                               .area());
-            }
-            if(opts.features.has(topology_feature_bit::triangle_weight)) {
-                assert(data.coords_per_vertex >= 1U);
-                const auto vpv = data.weights_per_vertex;
-                const auto& wgt = data.vertex_weights;
-                const auto ia = tri.vertex_index(0);
-                const auto ib = tri.vertex_index(1);
-                const auto ic = tri.vertex_index(2);
-                tri.set_weight(wgt[ia * vpv] + wgt[ib * vpv] + wgt[ic * vpv]);
-            }
-        }};
+    std::vector<edge_key> edges;
+    edges.reserve(tri_count * 3U);
+    for(auto& chunk : chunk_edges) {
+        edges.insert(edges.end(), chunk.begin(), chunk.end());
+        chunk = {};
+    }
+    parallel_topology_sort(workers(), edges);
 
-        if(operation.mode == primitive_type::triangles) {
-            for(i = 0; i < operation.count; i += 3) {
-                if(operation.cw_face_winding) {
-                    add_triangle(0, 1, 2);
-                } else {
-                    add_triangle(0, 2, 1);
-                }
+    std::vector<std::uint8_t> non_manifold_edges;
+    if(with_half_edges) {
+        non_manifold_edges.resize(tri_count * 3U, 0U);
+    }
+
+    std::vector<std::tuple<unsigned, unsigned, std::uint8_t, std::uint8_t>>
+      links;
+    for(auto group = edges.begin(); group != edges.end();) {
+        const auto group_end =
+          std::find_if(group, edges.end(), [&group](const auto& edge) {
+              return std::get<0>(edge) != std::get<0>(*group) or
+                     std::get<1>(edge) != std::get<1>(*group);
+          });
+        // more than two faces sharing an edge are not manifold
+        if(with_half_edges and std::distance(group, group_end) > 2) {
+            for(auto g = group; g != group_end; ++g) {
+                non_manifold_edges[std::get<2>(*g) * 3U + std::get<3>(*g)] =
+                  1U;
             }
-        } else if(operation.mode == primitive_type::triangle_strip) {
-            for(i = 2; i < operation.count; i += 2) {
-                if(is_pri()) {
-                    ++i;
-                    continue;
-                }
-                if(operation.cw_face_winding) {
-                    add_triangle(-2, -1, 0);
-                    add_triangle(0, -1, 1);
-                } else {
-                    add_triangle(-1, -2, 0);
-                    add_triangle(-1, 0, 1);
+        }
+        for(auto l = group; l != group_end; ++l) {
+            for(auto r = std::next(l); r != group_end; ++r) {
+                if(std::get<2>(*l) != std::get<2>(*r)) {
+                    links.emplace_back(
+                      std::get<2>(*l),
+                      std::get<2>(*r),
+                      std::get<3>(*l),
+                      std::get<3>(*r));
                 }
             }
         }
-        scan_ops.advance_progress();
+        group = group_end;
     }
-    scan_ops.finish();
+    parallel_topology_sort(workers(), links);
 
-    if(opts.features.has(topology_feature_bit::triangle_adjacency)) {
-        const auto scan_tris = progress().activity(
-          "processing shape triangles", integer(_triangles.size()));
-
-        for(auto& ltri : _triangles) {
-            const auto lidx = ltri.index();
-            for(auto& rtri : _triangles) {
-                const auto ridx = rtri.index();
-                if(lidx < ridx) {
-                    const auto key = std::make_tuple(
-                      std::min(lidx, ridx), std::max(lidx, ridx));
-                    if(not _edges.contains(key)) {
-                        auto [should_add, leb, lee, reb, ree] =
-                          ltri.setup_adjacent(rtri, data);
-                        if(should_add) {
-                            _edges.emplace(
-                              key, mesh_edge{ltri, leb, lee, rtri, reb, ree});
-                        }
-                    }
-                }
+    _adjacent.assign(tri_count * 3U, -1);
+    _opposite.assign(tri_count * 3U, 0U);
+    _edges.reserve(links.size());
+
+    const auto prevv{[](const std::uint8_t e) -> std::uint8_t {
+        return limit_cast<std::uint8_t>((e + 2U) % 3U);
+    }};
+
+    // the linked triangles are merged into the component
+    // of the one with the lowest index
+    std::vector<std::uint32_t> component_roots;
+    if(with_components) {
+        component_roots.resize(tri_count);
+        std::iota(component_roots.begin(), component_roots.end(), 0U);
+    }
+
+    for(auto link = links.begin(); link != links.end(); ++link) {
+        const auto& [lidx, ridx, leb, reb] = *link;
+        // only the first link between each pair of triangles is used
+        if(link != links.begin()) {
+            const auto& prev = *std::prev(link);
+            if(std::get<0>(prev) == lidx and std::get<1>(prev) == ridx) {
+                continue;
+            }
+        }
+        _adjacent[lidx * 3U + leb] = limit_cast<std::int32_t>(ridx);
+        _opposite[lidx * 3U + leb] = prevv(reb);
+        _adjacent[ridx * 3U + reb] = limit_cast<std::int32_t>(lidx);
+        _opposite[ridx * 3U + reb] = prevv(leb);
+        _edges.push_back({{lidx, ridx}, {leb, reb}});
+
+        if(with_components) {
+            const auto lroot{topology_component_root(component_roots, lidx)};
+            const auto rroot{topology_component_root(component_roots, ridx)};
+            component_roots[std::max(lroot, rroot)] = std::min(lroot, rroot);
+        }
+    }
+
+    if(with_half_edges) {
+        _scan_half_edges(data, std::move(non_manifold_edges));
+    }
+    if(with_components) {
+        _scan_components(data, std::move(component_roots));
+    }
+}
+//------------------------------------------------------------------------------
+// The twins are derived from the triangle adjacency, but only for pairs of
+// faces linked to each other and oriented consistently, so that traversing
+// the twins always terminates.
+void topology::_scan_half_edges(
+  const topology_data& data,
+  std::vector<std::uint8_t> non_manifold_edges) {
+    using index_type = mesh_half_edges::index_type;
+    auto& mesh = _half_edges;
+    const auto hec{_indices.size()};
+    const auto he{[](const std::size_t h) {
+        return limit_cast<index_type>(h);
+    }};
+
+    mesh._origin.resize(hec);
+    for(const auto h : integer_range(hec)) {
+        mesh._origin[h] = data.welded(_indices[h]);
+    }
+
+    mesh._twin.assign(hec, -1);
+    for(const auto h : integer_range(hec)) {
+        const auto adj{_adjacent[h]};
+        if((adj < 0) or non_manifold_edges[h]) {
+            continue;
+        }
+        const auto g{std_size(adj) * 3U + (_opposite[h] + 1U) % 3U};
+        const bool is_twin =
+          (_adjacent[g] == limit_cast<index_type>(h / 3U)) and
+          ((_opposite[g] + 1U) % 3U == h % 3U) and
+          (mesh._origin[g] == mesh.target(he(h))) and
+          (mesh.target(he(g)) == mesh._origin[h]);
+        if(is_twin) {
+            mesh._twin[h] = he(g);
+        } else {
+            non_manifold_edges[h] = 1U;
+        }
+    }
+
+    const auto vc{data.vertex_count()};
+    std::vector<span_size_t> outgoing(vc, 0);
+    mesh._vertex_half_edge.assign(vc, -1);
+    for(const auto h : integer_range(hec)) {
+        const auto v{mesh._origin[h]};
+        ++outgoing[v];
+        // start the one-rings of the boundary vertices on the outgoing
+        // boundary half-edge, which has no predecessor in the fan
+        if((mesh._vertex_half_edge[v] < 0) or mesh.is_boundary(he(h))) {
+            mesh._vertex_half_edge[v] = he(h);
+        }
+    }
+
+    mesh._non_manifold_vertices.assign(vc, 0U);
+    bool has_non_manifold_vertex{false};
+    for(const auto v : integer_range(vc)) {
+        span_size_t count{0};
+        for([[maybe_unused]] const auto h : mesh.one_ring(v)) {
+            ++count;
+        }
+        if(count != outgoing[v]) {
+            mesh._non_manifold_vertices[v] = 1U;
+            has_non_manifold_vertex = true;
+        }
+    }
+    if(not has_non_manifold_vertex) {
+        mesh._non_manifold_vertices.clear();
+    }
+
+    std::vector<std::uint8_t> visited(hec, 0U);
+    for(const auto h : integer_range(hec)) {
+        if(not mesh.is_boundary(he(h)) or visited[h]) {
+            continue;
+        }
+        auto g{he(h)};
+        do {
+            visited[std_size(g)] = 1U;
+            mesh._boundary.push_back(g);
+            // rotate around the end vertex to the next boundary half-edge
+            auto n{mesh_half_edges::next(g)};
+            for(std::size_t steps{0U}; not mesh.is_boundary(n) and steps < hec;
+                ++steps) {
+                n = mesh_half_edges::next(mesh.twin(n));
             }
-            scan_tris.advance_progress();
+            g = n;
+        } while((g != he(h)) and not visited[std_size(g)]);
+        mesh._boundary_offsets.push_back(span_size(mesh._boundary.size()));
+    }
+
+    if(std::none_of(
+         non_manifold_edges.begin(), non_manifold_edges.end(), [](auto f) {
+             return f != 0U;
+         })) {
+        non_manifold_edges.clear();
+    }
+    mesh._non_manifold_edges = std::move(non_manifold_edges);
+}
+//------------------------------------------------------------------------------
+// The roots are the lowest triangle indices in the components, so the
+// components are numbered in the order of their first triangles.
+void topology::_scan_components(
+  const topology_data& data,
+  std::vector<std::uint32_t> component_roots) {
+    const auto tri_count{std_size(triangle_count())};
+    _components.resize(tri_count);
+    std::uint32_t count{0U};
+    for(const auto t : integer_range(tri_count)) {
+        const auto root{topology_component_root(component_roots, to_index(t))};
+        _components[t] = (root == t) ? count++ : _components[root];
+    }
+
+    _component_offsets.assign(count + 1U, 0U);
+    for(const auto component : _components) {
+        ++_component_offsets[component + 1U];
+    }
+    std::partial_sum(
+      _component_offsets.begin(),
+      _component_offsets.end(),
+      _component_offsets.begin());
+
+    auto next{_component_offsets};
+    _component_order.resize(tri_count);
+    for(const auto t : integer_range(tri_count)) {
+        _component_order[next[_components[t]]++] = to_index(t);
+    }
+
+    const auto coords{std::min(data.coords_per_vertex, 3U)};
+    shape_bounding_box empty;
+    for(const auto c : integer_range(coords)) {
+        empty.min[c] = std::numeric_limits<float>::max();
+        empty.max[c] = std::numeric_limits<float>::lowest();
+    }
+    _component_bounds.assign(count, empty);
+    for(const auto t : integer_range(tri_count)) {
+        auto& bounds = _component_bounds[_components[t]];
+        for(const auto v : integer_range(3U)) {
+            const auto pos{data.values_of(_indices[t * 3U + v])};
+            for(const auto c : integer_range(coords)) {
+                bounds.min[c] = std::min(bounds.min[c], pos[c]);
+                bounds.max[c] = std::max(bounds.max[c], pos[c]);
+            }
+        }
+    }
+}
+//------------------------------------------------------------------------------
+auto topology::component_ordered_indices() const
+  -> std::vector<std::uint32_t> {
+    if(_component_order.empty()) {
+        return _indices;
+    }
+    std::vector<std::uint32_t> result;
+    result.reserve(_indices.size());
+    for(const auto t : _component_order) {
+        for(const auto v : integer_range(3U)) {
+            result.push_back(_indices[t * 3U + v]);
         }
     }
+    return result;
 }
 //------------------------------------------------------------------------------
 } // namespace eagine::shapes
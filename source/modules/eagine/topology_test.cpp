@@ -0,0 +1,317 @@
+/// @file
+///
+/// Copyright Matus Chochlik.
+/// Distributed under the Boost Software License, Version 1.0.
+/// See accompanying file LICENSE_1_0.txt or copy at
+/// https://www.boost.org/LICENSE_1_0.txt
+///
+
+#include <eagine/testing/unit_begin_ctx.hpp>
+import std;
+import eagine.core;
+import eagine.shapes;
+//------------------------------------------------------------------------------
+void topology_check_closed(
+  auto& test,
+  eagine::shared_holder<eagine::shapes::generator> gen,
+  eagine::main_ctx& ctx) {
+    test.ensure(bool(gen), "has generator");
+
+    eagine::shapes::topology_options opts;
+    opts.features = eagine::shapes::topology_feature_bit::triangle_adjacency;
+    const eagine::shapes::topology topo{gen, opts, ctx};
+
+    test.check(topo.triangle_count() > 0, "has triangles");
+    for(const auto t : eagine::integer_range(topo.triangle_count())) {
+        const auto tri{topo.triangle(t)};
+        for(const auto v : eagine::integer_range(3)) {
+            const auto adj{tri.adjacent_triangle(v)};
+            test.ensure(adj.has_value(), "has adjacent");
+            const auto o = tri.opposite_vertex(v);
+            test.check(
+              adj->adjacent_triangle((o + 1) % 3) == tri, "is symmetric");
+            test.check(
+              adj->opposite_index((o + 1) % 3) ==
+                tri.vertex_index((v + 2) % 3),
+              "opposite index");
+        }
+    }
+}
+//------------------------------------------------------------------------------
+void topology_adjacency_icosahedron(auto& s) {
+    eagitest::case_ test{s, 1, "adjacency icosahedron"};
+    auto gen{eagine::shapes::unit_icosahedron(
+      eagine::shapes::vertex_attrib_kind::position)};
+    topology_check_closed(test, gen, s.context());
+}
+//------------------------------------------------------------------------------
+void topology_adjacency_cube(auto& s) {
+    eagitest::case_ test{s, 2, "adjacency cube"};
+    auto gen{
+      eagine::shapes::unit_cube(eagine::shapes::vertex_attrib_kind::position)};
+    topology_check_closed(test, gen, s.context());
+}
+//------------------------------------------------------------------------------
+void topology_adjacency_torus(auto& s) {
+    eagitest::case_ test{s, 3, "adjacency torus"};
+    auto gen{eagine::shapes::unit_torus(
+      eagine::shapes::vertex_attrib_kind::position, 6, 12, 0.5F)};
+    topology_check_closed(test, gen, s.context());
+}
+//------------------------------------------------------------------------------
+void topology_compact_icosahedron(auto& s) {
+    eagitest::case_ test{s, 4, "compact icosahedron"};
+    auto gen{eagine::shapes::unit_icosahedron(
+      eagine::shapes::vertex_attrib_kind::position)};
+    test.ensure(bool(gen), "has generator");
+
+    eagine::shapes::topology_options opts;
+    opts.features = eagine::shapes::topology_feature_bit::triangle_adjacency |
+                    eagine::shapes::topology_feature_bit::triangle_area;
+    const eagine::shapes::topology topo{gen, opts, s.context()};
+
+    test.check(topo.triangle_count() == 20, "triangle count");
+    test.check(topo.edge_count() == 30, "edge count");
+    test.check(
+      topo.triangle_indices().size() == topo.triangle_count() * 3, "indices");
+    test.check(
+      topo.adjacent_triangles().size() == topo.triangle_count() * 3,
+      "adjacency");
+    test.check(
+      topo.triangle_areas().size() == topo.triangle_count(), "areas");
+    test.check(topo.triangle_weights().empty(), "no weights");
+
+    for(const auto t : eagine::integer_range(topo.triangle_count())) {
+        const auto tri{topo.triangle(t)};
+        test.check(tri.area() > 0.F, "positive area");
+        test.check(tri.weight() == 1.F, "default weight");
+        for(const auto v : eagine::integer_range(3)) {
+            test.check(
+              tri.vertex_index(v) == topo.triangle_indices()[t * 3 + v],
+              "same index");
+            test.check(
+              tri.adjacent_triangle(v)->index() ==
+                topo.adjacent_triangles()[t * 3 + v],
+              "same adjacent");
+        }
+    }
+}
+//------------------------------------------------------------------------------
+void topology_half_edges_torus(auto& s) {
+    eagitest::case_ test{s, 5, "half-edges torus"};
+    auto gen{eagine::shapes::unit_torus(
+      eagine::shapes::vertex_attrib_kind::position, 6, 12, 0.5F)};
+    test.ensure(bool(gen), "has generator");
+
+    eagine::shapes::topology_options opts;
+    opts.features = eagine::shapes::topology_feature_bit::half_edges;
+    const eagine::shapes::topology topo{gen, opts, s.context()};
+    const auto& mesh{topo.half_edges()};
+
+    test.ensure(not mesh.is_empty(), "has half-edges");
+    test.check(
+      mesh.half_edge_count() == topo.triangle_count() * 3, "half-edge count");
+    test.check(mesh.is_manifold(), "is manifold");
+    test.check(mesh.boundary_loop_count() == 0, "is closed");
+
+    for(const auto h : eagine::integer_range(mesh.half_edge_count())) {
+        const auto t{mesh.twin(std::int32_t(h))};
+        test.ensure(t >= 0, "has twin");
+        test.check(mesh.twin(t) == std::int32_t(h), "is symmetric");
+        test.check(mesh.origin(t) == mesh.target(std::int32_t(h)), "origin");
+    }
+
+    eagine::span_size_t ring_edges{0};
+    for(const auto v : eagine::integer_range(unsigned(mesh.vertex_count()))) {
+        for(const auto h : mesh.one_ring(v)) {
+            test.check(mesh.origin(h) == v, "outgoing");
+            ++ring_edges;
+        }
+    }
+    test.check(ring_edges == mesh.half_edge_count(), "one-rings");
+}
+//------------------------------------------------------------------------------
+void topology_half_edges_screen(auto& s) {
+    eagitest::case_ test{s, 6, "half-edges screen"};
+    auto gen{eagine::shapes::unit_screen(
+      eagine::shapes::vertex_attrib_kind::position)};
+    test.ensure(bool(gen), "has generator");
+
+    eagine::shapes::topology_options opts;
+    opts.features = eagine::shapes::topology_feature_bit::half_edges;
+    const eagine::shapes::topology topo{gen, opts, s.context()};
+    const auto& mesh{topo.half_edges()};
+
+    test.ensure(not mesh.is_empty(), "has half-edges");
+    test.check(mesh.is_manifold(), "is manifold");
+    test.ensure(mesh.boundary_loop_count() == 1, "one boundary loop");
+
+    const auto loop{mesh.boundary_loop(0)};
+    test.check(loop.size() == 4, "loop length");
+    for(const auto i : eagine::integer_range(loop.size())) {
+        const auto h{loop[i]};
+        test.check(mesh.is_boundary(h), "is boundary");
+        test.check(
+          mesh.target(h) == mesh.origin(loop[(i + 1) % loop.size()]),
+          "is connected");
+    }
+
+    bool has_shared_vertex{false};
+    for(const auto h : loop) {
+        const auto v{mesh.origin(h)};
+        test.check(mesh.is_manifold_vertex(v), "manifold vertex");
+        test.check(mesh.vertex_half_edge(v) == h, "starts on boundary");
+        eagine::span_size_t outgoing{0};
+        using index_type = eagine::shapes::mesh_half_edges::index_type;
+        for(index_type g{0}; g < mesh.half_edge_count(); ++g) {
+            if(mesh.origin(g) == v) {
+                ++outgoing;
+            }
+        }
+        eagine::span_size_t ring{0};
+        for(const auto g : mesh.one_ring(v)) {
+            test.check(mesh.origin(g) == v, "ring origin");
+            ++ring;
+        }
+        test.check(ring == outgoing, "one-ring length");
+        has_shared_vertex = has_shared_vertex or (outgoing > 1);
+    }
+    test.check(has_shared_vertex, "has vertex shared by faces");
+}
+//------------------------------------------------------------------------------
+void topology_serialization(auto& s) {
+    eagitest::case_ test{s, 7, "serialization"};
+    using eagine::shapes::topology_feature_bit;
+    auto gen{eagine::shapes::unit_torus(
+      eagine::shapes::vertex_attrib_kind::position)};
+    test.ensure(bool(gen), "has generator");
+
+    eagine::shapes::topology_options opts;
+    opts.features = topology_feature_bit::triangle_area |
+                    topology_feature_bit::half_edges;
+    const eagine::shapes::topology orig{gen, opts, s.context()};
+    test.check(not orig.is_loaded(), "is computed");
+
+    std::stringstream blob;
+    orig.write_to(blob);
+    const eagine::shapes::topology topo{gen, opts, blob, s.context()};
+    test.check(topo.is_loaded(), "is loaded");
+    test.check(topo.triangle_count() == orig.triangle_count(), "triangles");
+    test.check(topo.edge_count() == orig.edge_count(), "edges");
+    test.check(
+      std::ranges::equal(
+        topo.triangle_indices(), orig.triangle_indices()),
+      "same indices");
+    test.check(
+      std::ranges::equal(
+        topo.adjacent_triangles(), orig.adjacent_triangles()),
+      "same adjacency");
+    test.check(
+      std::ranges::equal(topo.triangle_areas(), orig.triangle_areas()),
+      "same areas");
+    test.check(
+      topo.half_edges().half_edge_count() ==
+        orig.half_edges().half_edge_count(),
+      "same half-edges");
+    test.check(
+      topo.half_edges().is_manifold() == orig.half_edges().is_manifold(),
+      "same manifoldness");
+
+    // coinciding planes share the edges by more than two triangles,
+    // which gives more edges than half-edges
+    const auto plane{[] {
+        return eagine::shapes::unit_plane(
+          eagine::shapes::vertex_attrib_kind::position);
+    }};
+    auto fan{eagine::shapes::combine(plane() + plane() + plane())};
+    test.ensure(bool(fan), "has non-manifold generator");
+    eagine::shapes::topology_options fan_opts;
+    fan_opts.features = topology_feature_bit::triangle_adjacency;
+    const eagine::shapes::topology fan_orig{fan, fan_opts, s.context()};
+    test.check(
+      fan_orig.edge_count() > fan_orig.triangle_count() * 3,
+      "more edges than half-edges");
+    std::stringstream fan_blob;
+    fan_orig.write_to(fan_blob);
+    const eagine::shapes::topology fan_topo{
+      fan, fan_opts, fan_blob, s.context()};
+    test.check(fan_topo.is_loaded(), "non-manifold is loaded");
+    test.check(
+      fan_topo.edge_count() == fan_orig.edge_count(), "non-manifold edges");
+
+    std::stringstream truncated{blob.str().substr(0, 64)};
+    const eagine::shapes::topology fallback{
+      gen, opts, truncated, s.context()};
+    test.check(not fallback.is_loaded(), "truncated");
+
+    std::stringstream other;
+    orig.write_to(other);
+    opts.features = topology_feature_bit::triangle_adjacency;
+    const eagine::shapes::topology recomputed{gen, opts, other, s.context()};
+    test.check(not recomputed.is_loaded(), "different options");
+    test.check(recomputed.triangle_count() == orig.triangle_count(), "valid");
+}
+//------------------------------------------------------------------------------
+void topology_connected_components(auto& s) {
+    eagitest::case_ test{s, 8, "connected components"};
+    using eagine::shapes::vertex_attrib_kind;
+    auto gen{eagine::shapes::combine(
+      eagine::shapes::translate(
+        eagine::shapes::unit_torus(vertex_attrib_kind::position, 6, 12, 0.5F),
+        {-2.F, 0.F, 0.F}) +
+      eagine::shapes::translate(
+        eagine::shapes::unit_torus(vertex_attrib_kind::position, 6, 12, 0.5F),
+        {2.F, 0.F, 0.F}))};
+    test.ensure(bool(gen), "has generator");
+
+    eagine::shapes::topology_options opts;
+    opts.features =
+      eagine::shapes::topology_feature_bit::connected_components;
+    const eagine::shapes::topology topo{gen, opts, s.context()};
+    test.ensure(topo.component_count() == 2, "two components");
+    test.check(
+      topo.triangle_components().size() == topo.triangle_count(),
+      "component of each triangle");
+
+    const auto half{topo.triangle_count() / 2};
+    for(const auto c : eagine::integer_range(topo.component_count())) {
+        const auto [first, count] = topo.component_triangle_range(c);
+        test.check(first == c * half, "range first");
+        test.check(count == half, "range count");
+        for(const auto t : topo.component_triangles(c)) {
+            test.check(
+              topo.triangle_components()[t] == std::uint32_t(c), "same id");
+        }
+    }
+    const auto& left{topo.component_bounds(0)};
+    const auto& right{topo.component_bounds(1)};
+    test.check(left.max[0] < 0.F, "left bounds");
+    test.check(right.min[0] > 0.F, "right bounds");
+    test.check(left.min[0] < left.max[0], "non-empty bounds");
+
+    const auto indices{topo.component_ordered_indices()};
+    test.check(
+      eagine::span_size(indices.size()) == topo.triangle_count() * 3,
+      "index count");
+}
+//------------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------------
+auto test_main(eagine::test_ctx& ctx) -> int {
+    eagitest::ctx_suite test{ctx, "topology", 8};
+    test.once(topology_adjacency_icosahedron);
+    test.once(topology_adjacency_cube);
+    test.once(topology_adjacency_torus);
+    test.once(topology_compact_icosahedron);
+    test.once(topology_half_edges_torus);
+    test.once(topology_half_edges_screen);
+    test.once(topology_serialization);
+    test.once(topology_connected_components);
+    return test.exit_code();
+}
+//------------------------------------------------------------------------------
+auto main(int argc, const char** argv) -> int {
+    return eagine::test_main_impl(argc, argv, test_main);
+}
+//------------------------------------------------------------------------------
+#include <eagine/testing/unit_end_ctx.hpp>
@@ -33,9 +33,14 @@ public:
     unit_torus_gen(const vertex_attrib_kinds attr_kinds) noexcept
       : unit_torus_gen(attr_kinds, 24, 36) {}
 
+    // returns the ring, section and tube radius offsets of a vertex
     using offset_getter =
       callable_ref<std::array<double, 3>(span_size_t, span_size_t)>;
 
+    // the largest relative tube radius offset returned by the offset getters
+    // of the attribute variants, the bounds must contain all variants
+    static constexpr const float max_radius_offset{0.F};
+
     auto vertex_count() -> span_size_t override;
 
     void pivot_pivots(span<float> dest) noexcept;
@@ -91,6 +96,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
 private:
     using _base = generator_base;
 
@@ -220,6 +227,7 @@ void unit_torus_gen::positions(
             const auto vx = std::cos((s + sd) * s_step);
             const auto vy = std::sin((r + rd) * r_step);
             const auto vz = -std::sin((s + sd) * s_step);
+            assert(td <= double(max_radius_offset));
             const auto rt = r2 * (1 + td);
 
             dest[k(s, r, 0)] = float(vx * (r1 + rt * (1 + vr)));
@@ -802,7 +810,21 @@ void unit_torus_gen::instructions(
 }
 //------------------------------------------------------------------------------
 auto unit_torus_gen::bounding_sphere() -> math::sphere<float> {
-    return {{}, 0.5F};
+    const auto ro = 0.25F;
+    const auto ri = ro * _radius_ratio;
+    const auto rt = (ro - ri) * (1.F + max_radius_offset);
+    return {{}, math::maximum(ri + 2.F * rt, 0.5F)};
+}
+//------------------------------------------------------------------------------
+auto unit_torus_gen::bounding_box() -> shape_bounding_box {
+    // see positions, the ring and section offsets only shift the angles
+    // and the tube radius offsets scale the tube radius
+    const auto ro = 0.25F;
+    const auto ri = ro * _radius_ratio;
+    const auto rt = (ro - ri) * (1.F + max_radius_offset);
+    const auto rxz = ri + 2.F * rt;
+    const auto ry = rt;
+    return {{-rxz, -ry, -rxz}, {rxz, ry, rxz}};
 }
 //------------------------------------------------------------------------------
 } // namespace eagine::shapes
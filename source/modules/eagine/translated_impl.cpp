@@ -24,6 +24,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
 private:
     std::array<float, 3> _d;
 };
@@ -62,4 +64,13 @@ auto translated_gen::bounding_sphere() -> math::sphere<float> {
     return {bs.center() + V{_d[0], _d[1], _d[2]}, bs.radius()};
 }
 //------------------------------------------------------------------------------
+auto translated_gen::bounding_box() -> shape_bounding_box {
+    auto bb = delegated_gen::bounding_box();
+    for(const auto c : integer_range(std_size(3))) {
+        bb.min[c] += _d[c];
+        bb.max[c] += _d[c];
+    }
+    return bb;
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
@@ -41,6 +41,8 @@ public:
 
     auto bounding_sphere() -> math::sphere<float> override;
 
+    auto bounding_box() -> shape_bounding_box override;
+
 private:
     using _base = generator_base;
 
@@ -347,5 +349,15 @@ auto unit_twisted_torus_gen::bounding_sphere() -> math::sphere<float> {
     return {{}, 0.5F};
 }
 //------------------------------------------------------------------------------
+auto unit_twisted_torus_gen::bounding_box() -> shape_bounding_box {
+    // see positions, the slip of the faces adds to the radii
+    const double ro = 0.25;
+    const double ri = ro * _radius_ratio;
+    const double slip = math::tau / double(_sections) * _thickness_ratio * 0.5;
+    const auto rxz = float(2.0 * ro - ri + slip);
+    const auto ry = float(ro - ri + slip);
+    return {{-rxz, -ry, -rxz}, {rxz, ry, rxz}};
+}
+//------------------------------------------------------------------------------
 } // namespace eagine::shapes
 